@@ -14,7 +14,12 @@ THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPL
 */
 
 #include "QVideoDecoder.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QMutexLocker>
 #include <limits.h>
+#include <algorithm>
 #include <stdint.h>
 #include "ffmpeg.h"
 
@@ -35,6 +40,7 @@ THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPL
 **/
 QVideoDecoder::QVideoDecoder()
 {
+   InitOptions();
    InitVars();
    initCodec();
 }
@@ -43,6 +49,7 @@ QVideoDecoder::QVideoDecoder()
 **/
 QVideoDecoder::QVideoDecoder(QString file)
 {
+   InitOptions();
    InitVars();
    initCodec();
 
@@ -61,9 +68,43 @@ void QVideoDecoder::InitVars()
    pCodecCtx=0;
    pCodec=0;
    pFrame=0;
-   pFrameRGB=0;
-   buffer=0;
    img_convert_ctx=0;
+   LastFrameOk=false;
+   LastFrameConverted=false;
+   Keyframes.clear();
+   LastIndexedFrame=-1;
+}
+
+void QVideoDecoder::InitOptions()
+{
+   IndexKeyframes=true;
+   PersistIndex=false;
+   ForwardDecodeLimit=25;
+   DecodeThreads=QThread::idealThreadCount();
+   PrefetchPackets=64;
+}
+
+/**
+   \brief Codec threads and the number of packets read ahead by the prefetch thread
+
+   The codec threads are used by the codecs that support them and take effect at the next openFile.
+   With prefetchPackets 0 the packets are read on the caller's thread.
+**/
+void QVideoDecoder::setThreading(int decodeThreads,int prefetchPackets)
+{
+   DecodeThreads=decodeThreads;
+   PrefetchPackets=prefetchPackets;
+}
+
+/**
+   \brief Whether openFile indexes the key frames, and keeps the index next to the video
+
+   The index makes seeks go straight to the key frame before the desired frame.
+**/
+void QVideoDecoder::setIndexing(bool index,bool persist)
+{
+   IndexKeyframes=index;
+   PersistIndex=persist;
 }
 
 void QVideoDecoder::close()
@@ -71,17 +112,16 @@ void QVideoDecoder::close()
    if(!ok)
       return;
 
-   // Free the RGB image
-   if(buffer)
-      delete [] buffer;
+   // The prefetch thread reads from the file
+   Prefetcher.stop();
 
    // Free the YUV frame
    if(pFrame)
       av_free(pFrame);
 
-   // Free the RGB frame
-   if(pFrameRGB)
-      av_free(pFrameRGB);
+   // Free the conversion context
+   if(img_convert_ctx)
+      ffmpeg::sws_freeContext(img_convert_ctx);
 
    // Close the codec
    if(pCodecCtx)
@@ -151,6 +191,10 @@ bool QVideoDecoder::openFile(QString filename)
    if(pCodec==NULL)
        return false; // Codec not found
 
+   // Codec threads, the codecs that can't use them ignore this
+   if(DecodeThreads>1)
+      ffmpeg::avcodec_thread_init(pCodecCtx,DecodeThreads);
+
    // Open codec
    if(avcodec_open(pCodecCtx, pCodec)<0)
        return false; // Could not open codec
@@ -162,21 +206,18 @@ bool QVideoDecoder::openFile(QString filename)
 
    // Allocate video frame
    pFrame=ffmpeg::avcodec_alloc_frame();
-
-   // Allocate an AVFrame structure
-   pFrameRGB=ffmpeg::avcodec_alloc_frame();
-   if(pFrameRGB==NULL)
+   if(pFrame==NULL)
        return false;
 
-   // Determine required buffer size and allocate buffer
-   numBytes=ffmpeg::avpicture_get_size(ffmpeg::PIX_FMT_RGB24, pCodecCtx->width,pCodecCtx->height);
-   buffer=new uint8_t[numBytes];
+   ok=true;
 
-   // Assign appropriate parts of buffer to image planes in pFrameRGB
-   avpicture_fill((ffmpeg::AVPicture *)pFrameRGB, buffer, ffmpeg::PIX_FMT_RGB24,
-       pCodecCtx->width, pCodecCtx->height);
+   // Index the key frames, or reuse the index of an earlier open
+   if(IndexKeyframes && !(PersistIndex && loadKeyframeIndex(filename)))
+   {
+      if(buildKeyframeIndex() && PersistIndex)
+         saveKeyframeIndex(filename);
+   }
 
-   ok=true;
    return true;
 }
 bool QVideoDecoder::isOk()
@@ -184,6 +225,19 @@ bool QVideoDecoder::isOk()
    return ok;
 }
 
+/**
+   \brief Next packet of the file, from the prefetch thread unless it is disabled
+**/
+bool QVideoDecoder::readPacket(ffmpeg::AVPacket &pkt)
+{
+   if(PrefetchPackets<=0)
+      return av_read_frame(pFormatCtx, &pkt)>=0;
+
+   if(!Prefetcher.isActive())
+      Prefetcher.begin(pFormatCtx,videoStream,PrefetchPackets);
+   return Prefetcher.read(pkt);
+}
+
 /**
    Decodes the video stream until the first frame with number larger or equal than 'after' is found.
 
@@ -224,9 +278,17 @@ bool QVideoDecoder::decodeSeekFrame(int after)
    bool done=false;
    while(!done)
    {
-      // Read a frame
-      if(av_read_frame(pFormatCtx, &packet)<0)
-         return false;                             // Frame read failed (e.g. end of stream)
+      // Read a frame. At the end of the stream the frames the codec (and its threads)
+      // still holds are drained with empty packets
+      bool draining=false;
+      if(!readPacket(packet))
+      {
+         ffmpeg::av_init_packet(&packet);
+         packet.data=NULL;
+         packet.size=0;
+         packet.stream_index=videoStream;
+         draining=true;
+      }
 
       //printf("Packet of stream %d, size %d\n",packet.stream_index,packet.size);
 
@@ -234,9 +296,15 @@ bool QVideoDecoder::decodeSeekFrame(int after)
       {
          // Is this a packet from the video stream -> decode video frame
 
+         // The codec may return a frame several packets later (threads, B-frames): the dts
+         // travels with the frame
          int frameFinished;
+         pCodecCtx->reordered_opaque=packet.dts;
          avcodec_decode_video2(pCodecCtx,pFrame,&frameFinished,&packet);
 
+         if(draining && !frameFinished)
+            return false;                          // End of stream, no frames left
+
          //printf("used %d out of %d bytes\n",len,packet.size);
 
          //printf("Frame type: ");
@@ -260,8 +328,8 @@ bool QVideoDecoder::decodeSeekFrame(int after)
          if(frameFinished)
          {
             ffmpeg::AVRational millisecondbase = {1, 1000};
-            int f = packet.dts;
-            int t = ffmpeg::av_rescale_q(packet.dts,pFormatCtx->streams[videoStream]->time_base,millisecondbase);
+            int f = pFrame->reordered_opaque;
+            int t = ffmpeg::av_rescale_q(pFrame->reordered_opaque,pFormatCtx->streams[videoStream]->time_base,millisecondbase);
             if(LastFrameOk==false)
             {
                LastFrameOk=true;
@@ -283,23 +351,8 @@ bool QVideoDecoder::decodeSeekFrame(int after)
             {
                // It's the desired frame
 
-               // Convert the image format (init the context the first time)
-               int w = pCodecCtx->width;
-               int h = pCodecCtx->height;
-               img_convert_ctx = ffmpeg::sws_getCachedContext(img_convert_ctx,w, h, pCodecCtx->pix_fmt, w, h, ffmpeg::PIX_FMT_RGB24, SWS_BICUBIC, NULL, NULL, NULL);
-
-               if(img_convert_ctx == NULL)
-               {
-                  printf("Cannot initialize the conversion context!\n");
-                  return false;
-               }
-               ffmpeg::sws_scale(img_convert_ctx, pFrame->data, pFrame->linesize, 0, pCodecCtx->height, pFrameRGB->data, pFrameRGB->linesize);
-
-               // Convert the frame to QImage
-               LastFrame=QImage(w,h,QImage::Format_RGB888);
-
-               for(int y=0;y<h;y++)
-                  memcpy(LastFrame.scanLine(y),pFrameRGB->data[0]+y*pFrameRGB->linesize[0],w*3);
+               // The frame stays in pFrame, getFrame converts it when it is asked for
+               LastFrameConverted=false;
 
                // Set the time
                DesiredFrameTime = ffmpeg::av_rescale_q(after,pFormatCtx->streams[videoStream]->time_base,millisecondbase);
@@ -365,30 +418,75 @@ bool QVideoDecoder::seekFrame(int64_t frame)
    // Seek if:
    // - we don't know where we are (Ok=false)
    // - we know where we are but:
-   //    - the desired frame is after the last decoded frame (this could be optimized: if the distance is small, calling decodeSeekFrame may be faster than seeking from the last key frame)
    //    - the desired frame is smaller or equal than the previous to the last decoded frame. Equal because if frame==LastLastFrameNumber we don't want the LastFrame, but the one before->we need to seek there
-   if( (LastFrameOk==false) || ((LastFrameOk==true) && (frame<=LastLastFrameNumber || frame>LastFrameNumber) ) )
+   //    - the desired frame is after the last decoded frame and decoding forward costs more than decoding from a key frame:
+   //      with the index, when there is a key frame after the last decoded frame (otherwise a seek would land on the same or an earlier key frame);
+   //      without it, when the desired frame is more than ForwardDecodeLimit frames ahead
+   bool seek = LastFrameOk==false || frame<=LastLastFrameNumber;
+   if(!seek && frame>LastFrameNumber)
+   {
+      if(!Keyframes.empty())
+         seek = getKeyframeBefore(frame)>LastFrameNumber;
+      else
+         seek = frame-LastFrameNumber>ForwardDecodeLimit;
+   }
+
+   if(seek)
    {
       //printf("\t avformat_seek_file\n");
-      if(ffmpeg::avformat_seek_file(pFormatCtx,videoStream,0,frame,frame,AVSEEK_FLAG_FRAME)<0)
+      // With the index, straight to the key frame before the desired frame
+      int64_t key = getKeyframeBefore(frame);
+      int64_t minTs = key>=0 ? key : 0;
+      int64_t ts = key>=0 ? key : frame;
+      Prefetcher.stop();
+      if(ffmpeg::avformat_seek_file(pFormatCtx,videoStream,minTs,ts,frame,AVSEEK_FLAG_FRAME)<0)
          return false;
 
       avcodec_flush_buffers(pCodecCtx);
 
-      DesiredFrameNumber = frame;
       LastFrameOk=false;
    }
+   DesiredFrameNumber = frame;
    //printf("\t decodeSeekFrame\n");
 
    return decodeSeekFrame(frame);
-
-   return true;
 }
 
 
 
+/**
+   \brief Converts the last decoded frame to RGB, once per frame
+
+   SWS_FAST_BILINEAR: there is no scaling, only the chroma is interpolated.
+   sws_scale writes the rows of the QImage directly.
+**/
+bool QVideoDecoder::convertFrame()
+{
+   int w = pCodecCtx->width;
+   int h = pCodecCtx->height;
+   img_convert_ctx = ffmpeg::sws_getCachedContext(img_convert_ctx,w, h, pCodecCtx->pix_fmt, w, h, ffmpeg::PIX_FMT_RGB24, SWS_FAST_BILINEAR, NULL, NULL, NULL);
+
+   if(img_convert_ctx == NULL)
+   {
+      printf("Cannot initialize the conversion context!\n");
+      return false;
+   }
+
+   // A new image, the previous one may still be used by the caller
+   LastFrame=QImage(w,h,QImage::Format_RGB888);
+   uint8_t *dst[4] = {LastFrame.bits(),0,0,0};
+   int dstStride[4] = {LastFrame.bytesPerLine(),0,0,0};
+   ffmpeg::sws_scale(img_convert_ctx, pFrame->data, pFrame->linesize, 0, h, dst, dstStride);
+
+   LastFrameConverted=true;
+   return true;
+}
+
 bool QVideoDecoder::getFrame(QImage&img,int *effectiveframenumber,int *effectiveframetime,int *desiredframenumber,int *desiredframetime)
 {
+   if(ok && LastFrameOk && !LastFrameConverted && !convertFrame())
+      return false;
+
    img = LastFrame;
 
    if(effectiveframenumber)
@@ -406,6 +504,31 @@ bool QVideoDecoder::getFrame(QImage&img,int *effectiveframenumber,int *effective
 }
 
 
+/**
+   \brief The planes of the last decoded frame, without conversion or copy
+
+   Only for planar YUV 4:2:0 video, false otherwise. The planes belong to the decoder and are
+   valid until the next seek or close. Rbe::wrapYcc420 wraps them in a Vi::Image.
+**/
+bool QVideoDecoder::getFrameYuv(uint8_t *planes[3],int linesizes[3],int *width,int *height)
+{
+   if(!ok || !LastFrameOk)
+      return false;
+   if(pCodecCtx->pix_fmt!=ffmpeg::PIX_FMT_YUV420P && pCodecCtx->pix_fmt!=ffmpeg::PIX_FMT_YUVJ420P)
+      return false;
+
+   for(int i=0;i<3;i++)
+   {
+      planes[i]=pFrame->data[i];
+      linesizes[i]=pFrame->linesize[i];
+   }
+   if(width)
+      *width=pCodecCtx->width;
+   if(height)
+      *height=pCodecCtx->height;
+   return true;
+}
+
 /**
   \brief Debug function: saves a frame as PPM
 **/
@@ -514,6 +637,122 @@ void QVideoDecoder::dumpFormat(ffmpeg::AVFormatContext *ic,
     ffmpeg::av_free(printed);
 }
 
+/**
+  \brief Scans the packets of the video stream for the key frames
+
+  Only demuxes, nothing is decoded. Afterwards the decoder is back at the start of the video.
+**/
+bool QVideoDecoder::buildKeyframeIndex()
+{
+   if(!ok)
+      return false;
+
+   Keyframes.clear();
+   LastIndexedFrame=-1;
+
+   Prefetcher.stop();
+   ffmpeg::AVPacket pkt;
+   while(av_read_frame(pFormatCtx, &pkt)>=0)
+   {
+      if(pkt.stream_index==videoStream && pkt.dts!=(int64_t)AV_NOPTS_VALUE)
+      {
+         if(pkt.flags & PKT_FLAG_KEY)
+            Keyframes.push_back(pkt.dts);
+         if(pkt.dts>LastIndexedFrame)
+            LastIndexedFrame=pkt.dts;
+      }
+      av_free_packet(&pkt);
+   }
+   std::sort(Keyframes.begin(),Keyframes.end());
+
+   // Rewind, we don't know where we are until the next decode
+   if(ffmpeg::avformat_seek_file(pFormatCtx,videoStream,0,0,0,AVSEEK_FLAG_FRAME)<0)
+      return false;
+   avcodec_flush_buffers(pCodecCtx);
+
+   LastLastFrameTime=INT_MIN;
+   LastFrameTime=0;
+   LastLastFrameNumber=INT_MIN;
+   LastFrameNumber=0;
+   DesiredFrameTime=DesiredFrameNumber=0;
+   LastFrameOk=false;
+
+   return !Keyframes.empty();
+}
+
+/**
+  \brief Reads the index of the video from <file>.idx
+
+  The index is only used when it was written for the same size and modification time of the video.
+**/
+bool QVideoDecoder::loadKeyframeIndex(QString filename)
+{
+   QFile file(filename+".idx");
+   if(!file.open(QIODevice::ReadOnly))
+      return false;
+
+   QFileInfo info(filename);
+   QDataStream in(&file);
+   quint32 magic,version,count;
+   qint64 size,modified,last;
+   in >> magic >> version >> size >> modified >> last >> count;
+   if(in.status()!=QDataStream::Ok || magic!=0x51564958 || version!=1 ||
+      size!=info.size() || modified!=(qint64)info.lastModified().toTime_t())
+      return false;
+
+   std::vector<int64_t> keyframes(count);
+   for(unsigned i=0;i<count;i++)
+   {
+      qint64 key;
+      in >> key;
+      keyframes[i]=key;
+   }
+   if(in.status()!=QDataStream::Ok || keyframes.empty())
+      return false;
+
+   Keyframes.swap(keyframes);
+   LastIndexedFrame=last;
+   return true;
+}
+
+/**
+  \brief Writes the index of the video to <file>.idx
+**/
+bool QVideoDecoder::saveKeyframeIndex(QString filename)
+{
+   QFile file(filename+".idx");
+   if(!file.open(QIODevice::WriteOnly))
+      return false;
+
+   QFileInfo info(filename);
+   QDataStream out(&file);
+   out << (quint32)0x51564958 << (quint32)1 << (qint64)info.size() << (qint64)info.lastModified().toTime_t()
+       << (qint64)LastIndexedFrame << (quint32)Keyframes.size();
+   for(unsigned i=0;i<Keyframes.size();i++)
+      out << (qint64)Keyframes[i];
+
+   return out.status()==QDataStream::Ok;
+}
+
+/**
+  \brief Frame number of the last key frame at or before frame, -1 if there is none or no index
+**/
+int64_t QVideoDecoder::getKeyframeBefore(int64_t frame)
+{
+   std::vector<int64_t>::const_iterator it = std::upper_bound(Keyframes.begin(),Keyframes.end(),frame);
+   if(it==Keyframes.begin())
+      return -1;
+   return *(it-1);
+}
+
+/**
+  \brief Largest frame number in the video, -1 without index
+**/
+int64_t QVideoDecoder::getLastFrameNumber()
+{
+   return LastIndexedFrame;
+}
+
 int QVideoDecoder::getVideoLengthMs()
 {
    if(!isOk())
@@ -529,3 +768,104 @@ int QVideoDecoder::getVideoLengthMs()
 
    return l;
 }
+
+
+
+/******************************************************************************
+*******************************************************************************
+* QPacketPrefetcher   QPacketPrefetcher   QPacketPrefetcher   QPacketPrefetcher
+*******************************************************************************
+******************************************************************************/
+
+QPacketPrefetcher::QPacketPrefetcher()
+{
+   FormatCtx=0;
+   Stream=-1;
+   MaxPackets=0;
+   Active=false;
+   Stop=End=false;
+}
+
+QPacketPrefetcher::~QPacketPrefetcher()
+{
+   stop();
+}
+
+void QPacketPrefetcher::begin(ffmpeg::AVFormatContext *formatCtx,int stream,int maxPackets)
+{
+   stop();
+
+   FormatCtx=formatCtx;
+   Stream=stream;
+   MaxPackets=maxPackets;
+   Stop=End=false;
+   Active=true;
+   start();
+}
+
+/**
+   \brief Stops the thread and drops the packets that were not read
+**/
+void QPacketPrefetcher::stop()
+{
+   if(!Active)
+      return;
+
+   Mutex.lock();
+   Stop=true;
+   NotFull.wakeAll();
+   Mutex.unlock();
+   wait();
+
+   while(!Packets.isEmpty())
+   {
+      ffmpeg::AVPacket pkt=Packets.dequeue();
+      av_free_packet(&pkt);
+   }
+   Active=false;
+}
+
+bool QPacketPrefetcher::read(ffmpeg::AVPacket &packet)
+{
+   QMutexLocker lock(&Mutex);
+   while(Packets.isEmpty() && !End)
+      NotEmpty.wait(&Mutex);
+   if(Packets.isEmpty())
+      return false;
+
+   packet=Packets.dequeue();
+   NotFull.wakeOne();
+   return true;
+}
+
+void QPacketPrefetcher::run()
+{
+   forever
+   {
+      ffmpeg::AVPacket pkt;
+      bool read = av_read_frame(FormatCtx, &pkt)>=0;
+      if(read && pkt.stream_index!=Stream)
+      {
+         av_free_packet(&pkt);
+         continue;
+      }
+      if(read)
+         av_dup_packet(&pkt);   // Own the data, the demuxer may reuse its buffer
+
+      QMutexLocker lock(&Mutex);
+      while(read && !Stop && Packets.size()>=MaxPackets)
+         NotFull.wait(&Mutex);
+
+      if(!read || Stop)
+      {
+         if(read)
+            av_free_packet(&pkt);
+         End=true;
+         NotEmpty.wakeAll();
+         return;
+      }
+
+      Packets.enqueue(pkt);
+      NotEmpty.wakeOne();
+   }
+}
@@ -19,10 +19,50 @@ THIS SOFTWARE IS PROVIDED BY COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPL
 
 #include <QIODevice>
 #include <QFile>
+#include <QString>
 #include <QImage>
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+#include <QWaitCondition>
 #include <stdint.h>
+#include <vector>
 #include "ffmpeg.h"
 
+/**
+   \brief Reads the packets of one stream ahead, in its own thread, into a bounded queue
+
+   The packets are duplicated (av_dup_packet), they stay valid when the demuxer reads on.
+   The demuxer must not be used by anyone else between begin and stop.
+**/
+class QPacketPrefetcher : public QThread
+{
+   public:
+      QPacketPrefetcher();
+      virtual ~QPacketPrefetcher();
+
+      void begin(ffmpeg::AVFormatContext *formatCtx,int stream,int maxPackets);
+      void stop();
+      bool isActive() const { return Active; }
+
+      // Blocks until a packet is read, false at the end of the stream
+      bool read(ffmpeg::AVPacket &packet);
+
+   protected:
+      virtual void run();
+
+   private:
+      ffmpeg::AVFormatContext *FormatCtx;
+      int Stream;
+      int MaxPackets;
+      bool Active;
+
+      QMutex Mutex;                    // Guards the members below
+      QWaitCondition NotEmpty,NotFull;
+      QQueue<ffmpeg::AVPacket> Packets;
+      bool Stop,End;
+};
+
 class QVideoDecoder
 {
    protected:
@@ -32,11 +72,8 @@ class QVideoDecoder
       ffmpeg::AVCodecContext  *pCodecCtx;
       ffmpeg::AVCodec         *pCodec;
       ffmpeg::AVFrame         *pFrame;
-      ffmpeg::AVFrame         *pFrameRGB;
       ffmpeg::AVPacket        packet;
       ffmpeg::SwsContext      *img_convert_ctx;
-      uint8_t                 *buffer;
-      int                     numBytes;
 
       // State infos for the wrapper
       bool ok;
@@ -44,17 +81,37 @@ class QVideoDecoder
       int LastFrameTime,LastLastFrameTime,LastLastFrameNumber,LastFrameNumber;
       int DesiredFrameTime,DesiredFrameNumber;
       bool LastFrameOk;                // Set upon start or after a seek we don't have a frame yet
+      bool LastFrameConverted;         // LastFrame holds the RGB conversion of pFrame
+
+      // Key frame index, built by openFile unless disabled with setIndexing
+      std::vector<int64_t> Keyframes;  // Frame numbers of the key frames, ascending
+      int64_t LastIndexedFrame;        // Largest frame number of the video stream
+      bool IndexKeyframes;             // Build the index when a file is opened
+      bool PersistIndex;               // Keep the index in <video>.idx
+      int ForwardDecodeLimit;          // Without index, frames ahead that are decoded instead of seeking
+
+      // Threading
+      int DecodeThreads;               // Codec threads, set before openFile
+      int PrefetchPackets;             // Packets read ahead, 0 reads on the caller's thread
+      QPacketPrefetcher Prefetcher;
 
       // Initialization functions
       virtual bool initCodec();
       virtual void InitVars();
+      virtual void InitOptions();
 
       // Helpers
       virtual void dumpFormat(ffmpeg::AVFormatContext *ic,int index,const char *url,int is_output);
       virtual void saveFramePPM(ffmpeg::AVFrame *pFrame, int width, int height, int iFrame);
 
       // Seek
+      virtual bool readPacket(ffmpeg::AVPacket &pkt);
       virtual bool decodeSeekFrame(int after);
+      virtual bool convertFrame();
+
+      // Key frame index file
+      virtual bool loadKeyframeIndex(QString file);
+      virtual bool saveKeyframeIndex(QString file);
 
    public:
       // Public interface
@@ -66,11 +123,18 @@ class QVideoDecoder
       virtual void close();
 
       virtual bool getFrame(QImage&img,int *effectiveframenumber=0,int *effectiveframetime=0,int *desiredframenumber=0,int *desiredframetime=0);
+      virtual bool getFrameYuv(uint8_t *planes[3],int linesizes[3],int *width=0,int *height=0);
       virtual bool seekNextFrame();
       virtual bool seekMs(int ts);
       virtual bool seekFrame(int64_t frame);
       virtual int getVideoLengthMs();
 
+      virtual void setThreading(int decodeThreads,int prefetchPackets);
+      virtual void setIndexing(bool index,bool persist=false);
+      virtual bool buildKeyframeIndex();
+      virtual int64_t getKeyframeBefore(int64_t frame);
+      virtual int64_t getLastFrameNumber();
+
 
       virtual bool isOk();
 };
@@ -0,0 +1,62 @@
+#################################################
+## rbe-bench: micro benchmark of the rule engine ##
+#################################################
+# the core does not use Qt
+QT -= core
+QT -= gui
+
+TARGET = rbe-bench
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+# benchmark numbers only make sense for an optimized build
+CONFIG -= debug
+CONFIG += release
+
+OBJECTS_DIR = .obj-bench
+
+HEADERS += \
+    src/core/Rule.hpp \
+    src/core/ObjectFrame.hpp \
+    src/core/Object.hpp \
+    src/core/Misc.hpp \
+    src/core/Raster.hpp \
+    src/core/EventContainer.hpp \
+    src/core/Event.hpp \
+    src/core/Engine.hpp \
+    src/core/EngineStats.hpp \
+    src/core/AlertIndex.hpp \
+    src/core/Trace.hpp \
+    src/core/ContextTripwire.hpp \
+    src/core/ContextArea.hpp \
+    src/core/Context.hpp \
+    src/core/Action.hpp \
+    src/core/EventFilter.hpp
+
+SOURCES += \
+    src/core/Rule.cpp \
+    src/core/ObjectFrame.cpp \
+    src/core/Object.cpp \
+    src/core/Raster.cpp \
+    src/core/EventContainer.cpp \
+    src/core/Event.cpp \
+    src/core/Engine.cpp \
+    src/core/EngineStats.cpp \
+    src/core/AlertIndex.cpp \
+    src/core/Trace.cpp \
+    src/core/ContextTripwire.cpp \
+    src/core/ContextArea.cpp \
+    src/core/Context.cpp \
+    src/core/Action.cpp \
+    src/core/EventFilter.cpp \
+    src/bench/RbeBench.cpp
+
+LIBS += -lboost_thread
+LIBS += -lpng
+
+#####################
+## link to libXml2 ##
+#####################
+LIBS += -lxml2
+INCLUDEPATH += /usr/include/libxml2
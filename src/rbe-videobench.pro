@@ -0,0 +1,94 @@
+#####################################################################
+## rbe-videobench: end-to-end throughput of the virtual fence pipeline ##
+#####################################################################
+QT += core
+QT += gui
+
+TARGET = rbe-videobench
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+# benchmark numbers only make sense for an optimized build
+CONFIG -= debug
+CONFIG += release
+
+OBJECTS_DIR = .obj-videobench
+
+HEADERS += \
+    src/core/Rule.hpp \
+    src/core/ObjectFrame.hpp \
+    src/core/Object.hpp \
+    src/core/Misc.hpp \
+    src/core/Raster.hpp \
+    src/core/EventContainer.hpp \
+    src/core/Event.hpp \
+    src/core/Engine.hpp \
+    src/core/EngineStats.hpp \
+    src/core/AlertIndex.hpp \
+    src/core/Trace.hpp \
+    src/core/ContextTripwire.hpp \
+    src/core/ContextArea.hpp \
+    src/core/Context.hpp \
+    src/core/Action.hpp \
+    src/core/EventFilter.hpp \
+    src/video/VideoInputY4M.hpp \
+    src/video/VideoInputImageSequence.hpp \
+    vinotion/VirtualFencing/VirtualFencing.hpp \
+    vinotion/VirtualFencing/TripWire.hpp \
+    vinotion/VirtualFencing/TrackedObjectVirtualFencingParams.hpp \
+    vinotion/VirtualFencing/TrackedObjectVirtualFencing.hpp \
+    vinotion/VirtualFencing/RuleBasedEngine.hpp \
+    vinotion/VirtualFencing/ResultFile.hpp \
+    vinotion/VirtualFencing/Recording.hpp \
+    vinotion/VirtualFencing/ContextFilter.hpp
+
+SOURCES += \
+    src/core/Rule.cpp \
+    src/core/ObjectFrame.cpp \
+    src/core/Object.cpp \
+    src/core/Raster.cpp \
+    src/core/EventContainer.cpp \
+    src/core/Event.cpp \
+    src/core/Engine.cpp \
+    src/core/EngineVirtualFence.cpp \
+    src/core/EngineStats.cpp \
+    src/core/AlertIndex.cpp \
+    src/core/Trace.cpp \
+    src/core/ContextTripwire.cpp \
+    src/core/ContextArea.cpp \
+    src/core/Context.cpp \
+    src/core/Action.cpp \
+    src/core/EventFilter.cpp \
+    src/video/VideoInputY4M.cpp \
+    src/video/VideoInputImageSequence.cpp \
+    vinotion/VirtualFencing/VirtualFencing.cpp \
+    vinotion/VirtualFencing/TripWire.cpp \
+    vinotion/VirtualFencing/TrackedObjectVirtualFencing.cpp \
+    vinotion/VirtualFencing/RuleBasedEngine.cpp \
+    vinotion/VirtualFencing/ResultFile.cpp \
+    vinotion/VirtualFencing/Recording.cpp \
+    vinotion/VirtualFencing/ContextFilter.cpp \
+    src/bench/RbeVideoBench.cpp
+
+###########################
+## link to vinotion libs ##
+###########################
+LIBS += -lViNotion
+LIBS += -lBackgroundSubtraction
+LIBS += -lVImageProcessing
+LIBS += -lTracking
+LIBS += -lMultipleHypothesesTracking 
+LIBS += -lGenericObject
+LIBS += -lSettings
+LIBS += -lFeatures
+LIBS += -lboost_thread
+LIBS += -lboost_filesystem
+LIBS += -lboost_system
+LIBS += -lpng
+
+#####################
+## link to libXml2 ##
+#####################
+LIBS += -lxml2
+INCLUDEPATH += /usr/include/libxml2
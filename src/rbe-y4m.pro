@@ -0,0 +1,26 @@
+##########################################################
+## rbe-y4m: convert a clip to an uncompressed .y4m file ##
+##########################################################
+QT -= core
+QT -= gui
+
+TARGET = rbe-y4m
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+OBJECTS_DIR = .obj-y4m
+
+HEADERS += \
+    src/video/VideoInputY4M.hpp
+
+SOURCES += \
+    src/video/VideoInputY4M.cpp \
+    src/bench/RbeY4M.cpp
+
+###########################
+## link to vinotion libs ##
+###########################
+LIBS += -lViNotion
+LIBS += -lboost_thread
+LIBS += -lpng
@@ -0,0 +1,61 @@
+######################################################################
+## rbe_core: the rule engine core as a static library without Qt ##
+######################################################################
+QT -= core
+QT -= gui
+
+TARGET = rbe_core
+TEMPLATE = lib
+CONFIG += staticlib
+
+OBJECTS_DIR = .obj-core
+
+HEADERS += \
+    src/core/Rule.hpp \
+    src/core/ObjectFrame.hpp \
+    src/core/Object.hpp \
+    src/core/Misc.hpp \
+    src/core/Raster.hpp \
+    src/core/PolygonRasterizer.hpp \
+    src/core/EventContainer.hpp \
+    src/core/Event.hpp \
+    src/core/Engine.hpp \
+    src/core/EngineStats.hpp \
+    src/core/AlertIndex.hpp \
+    src/core/Trace.hpp \
+    src/core/TrackLog.hpp \
+    src/core/ContextTripwire.hpp \
+    src/core/ContextArea.hpp \
+    src/core/Context.hpp \
+    src/core/Action.hpp \
+    src/core/EventFilter.hpp
+
+# EngineVirtualFence.cpp needs the ViNotion tracker and stays in the applications
+SOURCES += \
+    src/core/Rule.cpp \
+    src/core/ObjectFrame.cpp \
+    src/core/Object.cpp \
+    src/core/Raster.cpp \
+    src/core/PolygonRasterizer.cpp \
+    src/core/EventContainer.cpp \
+    src/core/Event.cpp \
+    src/core/Engine.cpp \
+    src/core/EngineStats.cpp \
+    src/core/AlertIndex.cpp \
+    src/core/Trace.cpp \
+    src/core/TrackLog.cpp \
+    src/core/ContextTripwire.cpp \
+    src/core/ContextArea.cpp \
+    src/core/Context.cpp \
+    src/core/Action.cpp \
+    src/core/EventFilter.cpp
+
+# applications linking librbe_core.a also need these
+LIBS += -lboost_thread
+LIBS += -lpng
+
+#####################
+## link to libXml2 ##
+#####################
+LIBS += -lxml2
+INCLUDEPATH += /usr/include/libxml2
@@ -16,9 +16,15 @@ HEADERS += \
     src/core/ObjectFrame.hpp \
     src/core/Object.hpp \
     src/core/Misc.hpp \
+    src/core/Raster.hpp \
+    src/core/PolygonRasterizer.hpp \
     src/core/EventContainer.hpp \
     src/core/Event.hpp \
     src/core/Engine.hpp \
+    src/core/EngineStats.hpp \
+    src/core/AlertIndex.hpp \
+    src/core/Trace.hpp \
+    src/core/TrackLog.hpp \
     src/core/ContextTripwire.hpp \
     src/core/ContextArea.hpp \
     src/core/Context.hpp \
@@ -31,6 +37,10 @@ HEADERS += \
     src/gui/RbeVisualizeWidget_GraphicsScene.hpp \
     src/gui/RbeVisualizeWidget.hpp \
     src/gui/RbeVirtualFence.hpp \
+    src/gui/RbeVirtualFenceThread.hpp \
+    src/gui/RbePreviewQueue.hpp \
+    src/gui/RbeVideoBackdrop.hpp \
+    src/gui/RbeDetectionOverlay.hpp \
     src/gui/RbePropertyTree.hpp \
     src/gui/RbeItemTree_WidgetItem.hpp \
     src/gui/RbeItemTree.hpp \
@@ -48,15 +58,30 @@ HEADERS += \
     vinotion/VirtualFencing/Recording.hpp \
     vinotion/VirtualFencing/ContextFilter.hpp \
     src/core/EventFilter.hpp \
-    src/gui/RuleProcessingPanel.hpp
+    src/gui/RuleProcessingPanel.hpp \
+    src/video/ClipRecorder.hpp \
+    src/video/FramePool.hpp \
+    src/video/AsyncFrameWriter.hpp \
+    src/video/ProcessingRoi.hpp \
+    src/video/FrameScaler.hpp \
+    src/video/YuvView.hpp \
+    src/video/MotionGate.hpp \
+    src/video/LoadShedder.hpp
 
 SOURCES += \
     src/core/Rule.cpp \
     src/core/ObjectFrame.cpp \
     src/core/Object.cpp \
+    src/core/Raster.cpp \
+    src/core/PolygonRasterizer.cpp \
     src/core/EventContainer.cpp \
     src/core/Event.cpp \
     src/core/Engine.cpp \
+    src/core/EngineVirtualFence.cpp \
+    src/core/EngineStats.cpp \
+    src/core/AlertIndex.cpp \
+    src/core/Trace.cpp \
+    src/core/TrackLog.cpp \
     src/core/ContextTripwire.cpp \
     src/core/ContextArea.cpp \
     src/core/Context.cpp \
@@ -70,6 +95,10 @@ SOURCES += \
     src/gui/RbeVisualizeWidget_GraphicsScene.cpp \
     src/gui/RbeVisualizeWidget.cpp \
     src/gui/RbeVirtualFence.cpp \
+    src/gui/RbeVirtualFenceThread.cpp \
+    src/gui/RbePreviewQueue.cpp \
+    src/gui/RbeVideoBackdrop.cpp \
+    src/gui/RbeDetectionOverlay.cpp \
     src/gui/RbePropertyTree.cpp \
     src/gui/RbeItemTree_WidgetItem.cpp \
     src/gui/RbeItemTree.cpp \
@@ -87,7 +116,15 @@ SOURCES += \
     vinotion/VirtualFencing/ContextFilter.cpp \
     src/gui/help.cpp \
     src/core/EventFilter.cpp \
-    src/gui/RuleProcessingPanel.cpp
+    src/gui/RuleProcessingPanel.cpp \
+    src/video/ClipRecorder.cpp \
+    src/video/FramePool.cpp \
+    src/video/AsyncFrameWriter.cpp \
+    src/video/ProcessingRoi.cpp \
+    src/video/FrameScaler.cpp \
+    src/video/YuvView.cpp \
+    src/video/MotionGate.cpp \
+    src/video/LoadShedder.cpp
 
 FORMS += \
     src/gui/RuleProcessingPanel.ui
@@ -112,6 +149,14 @@ LIBS += -lGenericObject
 LIBS += -lSettings
 LIBS += -lFeatures
 LIBS += -lboost_thread
+LIBS += -lpng
+
+################################################
+## link to ffmpeg (ClipRecorder encodes itself) ##
+################################################
+LIBS += -lavformat
+LIBS += -lavcodec
+LIBS += -lavutil
 
 #####################
 ## link to libXml2 ##
@@ -0,0 +1,542 @@
+/** \file
+  * rbe-bench: micro benchmark of Engine::processRule on synthetic scenes.
+  *
+  * A scene has N objects moving around in a 640x480 frame, M contexts (half
+  * areas in a shared mask, half tripwires) and K rules. Every rule is a chain
+  * of event containers of the given nesting depth, the container types are
+  * taken round robin from the combinator mix. The benchmark sweeps all
+  * combinations of the given N, M and K values and reports per scene
+  * ns/frame, ns/object, allocations/frame and the peak RSS. Every scene runs
+  * in a child process, so the peak RSS is that of the scene.
+  *
+  * Usage: rbe-bench [-f frames] [-n 1,10,100] [-m 2,8] [-k 1,10] [-d depth]
+  *                  [-x AND,OR,SEQUENCE] [-s seed] [-j result.json]
+  *
+  * $Id$
+  */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <stdint.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "src/core/Engine.hpp"
+#include "src/core/EngineStats.hpp"
+#include "src/core/Rule.hpp"
+#include "src/core/EventContainer.hpp"
+#include "src/core/Event.hpp"
+#include "src/core/Object.hpp"
+#include "src/core/ObjectFrame.hpp"
+#include "src/core/ContextArea.hpp"
+#include "src/core/ContextTripwire.hpp"
+#include "src/core/Misc.hpp"
+#include "src/core/Raster.hpp"
+
+// ===========================
+// === allocation counting ===
+// ===========================
+
+static uint64_t gAllocations = 0;
+
+// dynamic exception specifications are gone since C++17
+#if __cplusplus >= 201103L
+#define RBE_THROW_BAD_ALLOC
+#define RBE_NOTHROW noexcept
+#else
+#define RBE_THROW_BAD_ALLOC throw(std::bad_alloc)
+#define RBE_NOTHROW throw()
+#endif
+
+void *operator new(size_t size) RBE_THROW_BAD_ALLOC
+{
+  gAllocations++;
+  void *p = malloc(size == 0 ? 1 : size);
+  if(p == NULL)
+    throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[](size_t size) RBE_THROW_BAD_ALLOC
+{
+  return operator new(size);
+}
+
+void operator delete(void *p) RBE_NOTHROW
+{
+  free(p);
+}
+
+void operator delete[](void *p) RBE_NOTHROW
+{
+  free(p);
+}
+
+#if __cpp_sized_deallocation
+void operator delete(void *p, size_t) RBE_NOTHROW
+{
+  free(p);
+}
+
+void operator delete[](void *p, size_t) RBE_NOTHROW
+{
+  free(p);
+}
+#endif
+
+namespace
+{
+  const int FRAME_WIDTH = 640;
+  const int FRAME_HEIGHT = 480;
+  const unsigned TRAJECTORY_LENGTH = 20;  ///< trajectory points kept per object.
+  const unsigned WARMUP_FRAMES = 50;
+  const double FRAME_RATE = 25;  ///< frame rate of the synthetic scenes, for the SEQUENCE windows.
+
+  /// benchmark options.
+  struct Options
+  {
+    unsigned frames;
+    std::vector<unsigned> objects;
+    std::vector<unsigned> contexts;
+    std::vector<unsigned> rules;
+    unsigned depth;
+    std::vector<std::string> mix;
+    unsigned seed;
+    std::string jsonFile;
+  };
+
+  /// result of one scene.
+  struct Result
+  {
+    unsigned objects;
+    unsigned contexts;
+    unsigned rules;
+    double nsPerFrame;
+    double nsPerObject;
+    double allocationsPerFrame;
+    long peakRssKb;
+  };
+
+  /// one synthetic moving object.
+  struct MovingObject
+  {
+    Rbe::Object *object;
+    int x, y, dx, dy;
+    std::vector<Rbe::Point> trajectory;
+  };
+
+  /// everything created for one scene, deleted afterwards (the engine does not own it).
+  struct Scene
+  {
+    std::vector<MovingObject> objects;
+    std::vector<Rbe::Context *> contexts;
+    std::vector<Rbe::Rule *> rules;
+    std::vector<Rbe::EventContainer *> containers;
+    std::vector<Rbe::Event *> events;
+  };
+
+  /// simple deterministic random generator, so runs are comparable.
+  unsigned nextRandom(unsigned &state)
+  {
+    state = state * 1103515245u + 12345u;
+    return (state >> 16) & 0x7fff;
+  }
+
+  int randomRange(unsigned &state, int low, int high)
+  {
+    return low + (int)(nextRandom(state) % (unsigned)(high - low + 1));
+  }
+
+  std::vector<unsigned> parseList(const std::string &value)
+  {
+    std::vector<unsigned> list;
+    std::stringstream stream(value);
+    std::string item;
+    while(std::getline(stream, item, ','))
+      if(!item.empty())
+        list.push_back(atoi(item.c_str()));
+    return list;
+  }
+
+  std::vector<std::string> parseStringList(const std::string &value)
+  {
+    std::vector<std::string> list;
+    std::stringstream stream(value);
+    std::string item;
+    while(std::getline(stream, item, ','))
+      if(!item.empty())
+        list.push_back(item);
+    return list;
+  }
+
+  void buildAreas(Scene &scene, Rbe::Engine &engine, unsigned nbAreas, const std::string &maskPath)
+  {
+    if(nbAreas == 0)
+      return;
+
+    // the areas are rectangles in a grid, each with its own colour in one mask
+    Rbe::Raster mask(FRAME_WIDTH, FRAME_HEIGHT, Rbe::Color(0, 0, 0, 255).rgba());
+
+    unsigned columns = 1;
+    while(columns * columns < nbAreas)
+      columns++;
+    int cellWidth = FRAME_WIDTH / columns;
+    int cellHeight = FRAME_HEIGHT / columns;
+
+    for(unsigned i = 0; i < nbAreas; i++)
+    {
+      Rbe::Color color(40 + (i * 53) % 200, 40 + (i * 97) % 200, 40 + (i * 31) % 200, 255);
+
+      int x0 = (i % columns) * cellWidth + cellWidth / 4;
+      int y0 = (i / columns) * cellHeight + cellHeight / 4;
+      for(int y = y0; y < y0 + cellHeight / 2; y++)
+        for(int x = x0; x < x0 + cellWidth / 2; x++)
+          mask.setPixel(x, y, color.rgba());
+    }
+    mask.savePng(maskPath);
+
+    for(unsigned i = 0; i < nbAreas; i++)
+    {
+      std::ostringstream name;
+      name << "area" << i;
+
+      Rbe::ContextArea *area = new Rbe::ContextArea(i, Rbe::Context::AREA, name.str(), "synthetic area");
+      area->setMaskFilePath(maskPath);
+      area->setMaskImage(maskPath);
+      area->setColor(40 + (i * 53) % 200, 40 + (i * 97) % 200, 40 + (i * 31) % 200, 255);
+
+      scene.contexts.push_back(area);
+      engine.addContext(area);
+    }
+  }
+
+  void buildTripwires(Scene &scene, Rbe::Engine &engine, unsigned firstId, unsigned nbTripwires, unsigned &random)
+  {
+    for(unsigned i = 0; i < nbTripwires; i++)
+    {
+      std::ostringstream name;
+      name << "tripwire" << i;
+
+      Rbe::Line line;
+      line.point1.x = randomRange(random, 10, FRAME_WIDTH / 2 - 10);
+      line.point1.y = randomRange(random, 10, FRAME_HEIGHT - 10);
+      line.point2.x = randomRange(random, FRAME_WIDTH / 2 + 10, FRAME_WIDTH - 10);
+      line.point2.y = randomRange(random, 10, FRAME_HEIGHT - 10);
+
+      Rbe::ContextTripwire *tripwire = new Rbe::ContextTripwire(firstId + i, Rbe::Context::TRIPWIRE, name.str(), "synthetic tripwire");
+      tripwire->setLine(line);
+
+      scene.contexts.push_back(tripwire);
+      engine.addContext(tripwire);
+    }
+  }
+
+  /// a chain of containers, every level has two events and (except the last) one sub container.
+  Rbe::EventContainer *buildContainer(Scene &scene, const Options &options, unsigned rule, unsigned level)
+  {
+    static const char *eventTypes[] = {"ENTER_AREA", "CROSSING_TRIPWIRE", "LEAVE_AREA", "CROSSING_TRIPWIRE_LEFT2RIGHT"};
+
+    const std::string &type = options.mix[(rule + level) % options.mix.size()];
+    Rbe::EventContainer *container = new Rbe::EventContainer(type);
+    if(type == "SEQUENCE")
+      container->mSecond = 2.0;
+    scene.containers.push_back(container);
+
+    if(level + 1 < options.depth)
+      container->addContainer(buildContainer(scene, options, rule, level + 1));
+
+    for(unsigned i = 0; i < 2; i++)
+    {
+      Rbe::Event *event = new Rbe::Event(eventTypes[(rule + level + i) % 4]);
+      scene.events.push_back(event);
+      container->addEvent(event);
+    }
+
+    return container;
+  }
+
+  void buildRules(Scene &scene, Rbe::Engine &engine, const Options &options, unsigned nbRules)
+  {
+    for(unsigned i = 0; i < nbRules; i++)
+    {
+      std::ostringstream name;
+      name << "rule" << i;
+
+      Rbe::Rule *rule = new Rbe::Rule(i, name.str(), "synthetic rule");
+      rule->setEventContainer(buildContainer(scene, options, i, 0));
+
+      scene.rules.push_back(rule);
+      engine.addRule(rule);
+    }
+  }
+
+  void buildObjects(Scene &scene, Rbe::Engine &engine, unsigned nbObjects, unsigned &random)
+  {
+    scene.objects.resize(nbObjects);
+    for(unsigned i = 0; i < nbObjects; i++)
+    {
+      MovingObject &moving = scene.objects[i];
+      moving.object = new Rbe::Object();
+      moving.object->setId(i);
+      moving.x = randomRange(random, 20, FRAME_WIDTH - 20);
+      moving.y = randomRange(random, 20, FRAME_HEIGHT - 20);
+      do
+      {
+        moving.dx = randomRange(random, -6, 6);
+        moving.dy = randomRange(random, -6, 6);
+      } while(moving.dx == 0 && moving.dy == 0);
+
+      engine.addObject(moving.object);
+    }
+  }
+
+  /// move the objects one step, as the tracker would update them.
+  void moveObjects(Scene &scene)
+  {
+    const int width = 20, height = 40;
+
+    for(unsigned i = 0; i < scene.objects.size(); i++)
+    {
+      MovingObject &moving = scene.objects[i];
+
+      moving.x += moving.dx;
+      moving.y += moving.dy;
+      if(moving.x < 0 || moving.x + width >= FRAME_WIDTH)
+      {
+        moving.dx = -moving.dx;
+        moving.x += 2 * moving.dx;
+      }
+      if(moving.y < 0 || moving.y + height >= FRAME_HEIGHT)
+      {
+        moving.dy = -moving.dy;
+        moving.y += 2 * moving.dy;
+      }
+
+      Rbe::ObjectFrame *frame = moving.object->getCurrentObjectFrame();
+      frame->setX(moving.x);
+      frame->setY(moving.y);
+      frame->setWidth(width);
+      frame->setHeight(height);
+
+      Rbe::Point center;
+      center.x = frame->getXCenter();
+      center.y = frame->getYCenter();
+      moving.trajectory.push_back(center);
+      if(moving.trajectory.size() > TRAJECTORY_LENGTH)
+        moving.trajectory.erase(moving.trajectory.begin());
+
+      moving.object->clearTrajectory();
+      for(unsigned p = 0; p < moving.trajectory.size(); p++)
+        moving.object->addTrajectory(moving.trajectory[p]);
+    }
+  }
+
+  void deleteScene(Scene &scene)
+  {
+    for(unsigned i = 0; i < scene.objects.size(); i++)
+      delete scene.objects[i].object;
+    for(unsigned i = 0; i < scene.contexts.size(); i++)
+      delete scene.contexts[i];
+    for(unsigned i = 0; i < scene.events.size(); i++)
+      delete scene.events[i];
+    for(unsigned i = 0; i < scene.containers.size(); i++)
+      delete scene.containers[i];
+    for(unsigned i = 0; i < scene.rules.size(); i++)
+      delete scene.rules[i];
+  }
+
+  long peakRssKb()
+  {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+  }
+
+  Result runScene(const Options &options, unsigned nbObjects, unsigned nbContexts, unsigned nbRules)
+  {
+    unsigned random = options.seed;
+    const char *tmp = getenv("TMPDIR");
+    std::string maskPath = std::string(tmp != NULL ? tmp : "/tmp") + "/rbe-bench-mask.png";
+
+    Result result;
+    result.objects = nbObjects;
+    result.contexts = nbContexts;
+    result.rules = nbRules;
+
+    Scene scene;
+    {
+      Rbe::Engine engine;
+
+      unsigned nbAreas = (nbContexts + 1) / 2;
+      buildAreas(scene, engine, nbAreas, maskPath);
+      buildTripwires(scene, engine, nbAreas, nbContexts - nbAreas, random);
+      buildRules(scene, engine, options, nbRules);
+      buildObjects(scene, engine, nbObjects, random);
+
+      for(unsigned f = 0; f < WARMUP_FRAMES; f++)
+      {
+        moveObjects(scene);
+        engine.setFrameTime(f / FRAME_RATE);
+        engine.processRule();
+        engine.cleanRuleEventResultQueue();
+      }
+
+      // only the engine is measured, not the synthetic tracker
+      uint64_t elapsed = 0;
+      uint64_t allocations = 0;
+      for(unsigned f = 0; f < options.frames; f++)
+      {
+        moveObjects(scene);
+        engine.setFrameTime((WARMUP_FRAMES + f) / FRAME_RATE);
+
+        uint64_t allocationsBefore = gAllocations;
+        uint64_t start = Rbe::EngineStats::now();
+
+        engine.processRule();
+        engine.cleanRuleEventResultQueue();
+
+        elapsed += Rbe::EngineStats::now() - start;
+        allocations += gAllocations - allocationsBefore;
+      }
+
+      result.nsPerFrame = (double)elapsed / options.frames;
+      result.nsPerObject = nbObjects > 0 ? result.nsPerFrame / nbObjects : 0.0;
+      result.allocationsPerFrame = (double)allocations / options.frames;
+      result.peakRssKb = peakRssKb();
+    }
+    deleteScene(scene);
+
+    return result;
+  }
+
+  /// run the scene in a child process, so its peak RSS is not that of an earlier scene.
+  Result runSceneIsolated(const Options &options, unsigned nbObjects, unsigned nbContexts, unsigned nbRules)
+  {
+    int fds[2];
+    pid_t pid = pipe(fds) == 0 ? fork() : -1;
+    if(pid == 0)
+    {
+      close(fds[0]);
+      Result result = runScene(options, nbObjects, nbContexts, nbRules);
+      ssize_t written = write(fds[1], &result, sizeof(result));
+      _exit(written == (ssize_t)sizeof(result) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    if(pid < 0)
+    {
+      std::cout << "Warning: cannot fork, the peak RSS is that of the process" << std::endl;
+      return runScene(options, nbObjects, nbContexts, nbRules);
+    }
+
+    close(fds[1]);
+    Result result;
+    ssize_t got = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if(got != (ssize_t)sizeof(result))
+    {
+      std::cout << "Error: the scene with " << nbObjects << " objects, " << nbContexts
+                << " contexts and " << nbRules << " rules failed" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    return result;
+  }
+
+  void usage()
+  {
+    std::cout << "Usage: rbe-bench [-f frames] [-n objects,...] [-m contexts,...] [-k rules,...]\n"
+              << "                 [-d depth] [-x AND,OR,SEQUENCE] [-s seed] [-j result.json]\n";
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  Options options;
+  options.frames = 1000;
+  options.objects = parseList("1,10,50,100");
+  options.contexts = parseList("2,8,32");
+  options.rules = parseList("1,10,50");
+  options.depth = 2;
+  options.mix = parseStringList("AND,OR,SEQUENCE");
+  options.seed = 1;
+
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if(arg == "-h" || arg == "--help")
+    {
+      usage();
+      return EXIT_SUCCESS;
+    }
+    if(i + 1 >= argc)
+    {
+      usage();
+      return EXIT_FAILURE;
+    }
+
+    std::string value = argv[++i];
+    if(arg == "-f") options.frames = atoi(value.c_str());
+    else if(arg == "-n") options.objects = parseList(value);
+    else if(arg == "-m") options.contexts = parseList(value);
+    else if(arg == "-k") options.rules = parseList(value);
+    else if(arg == "-d") options.depth = atoi(value.c_str());
+    else if(arg == "-x") options.mix = parseStringList(value);
+    else if(arg == "-s") options.seed = atoi(value.c_str());
+    else if(arg == "-j") options.jsonFile = value;
+    else
+    {
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+
+  if(options.frames == 0 || options.depth == 0 || options.mix.empty())
+  {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  std::vector<Result> results;
+
+  std::cout << "objects contexts rules   ns/frame  ns/object  allocs/frame  peakRSS(kB)" << std::endl;
+  for(unsigned n = 0; n < options.objects.size(); n++)
+    for(unsigned m = 0; m < options.contexts.size(); m++)
+      for(unsigned k = 0; k < options.rules.size(); k++)
+      {
+        Result r = runSceneIsolated(options, options.objects[n], options.contexts[m], options.rules[k]);
+        results.push_back(r);
+
+        char line[128];
+        snprintf(line, sizeof(line), "%7u %8u %5u %10.0f %10.1f %13.1f %12ld",
+                 r.objects, r.contexts, r.rules, r.nsPerFrame, r.nsPerObject, r.allocationsPerFrame, r.peakRssKb);
+        std::cout << line << std::endl;
+      }
+
+  if(!options.jsonFile.empty())
+  {
+    std::ofstream json(options.jsonFile.c_str());
+    json << "{\"frames\":" << options.frames << ",\"depth\":" << options.depth << ",\"results\":[";
+    for(unsigned i = 0; i < results.size(); i++)
+    {
+      const Result &r = results[i];
+      json << (i > 0 ? "," : "") << "\n{\"objects\":" << r.objects
+           << ",\"contexts\":" << r.contexts
+           << ",\"rules\":" << r.rules
+           << ",\"ns_per_frame\":" << r.nsPerFrame
+           << ",\"ns_per_object\":" << r.nsPerObject
+           << ",\"allocations_per_frame\":" << r.allocationsPerFrame
+           << ",\"peak_rss_kb\":" << r.peakRssKb << "}";
+    }
+    json << "\n]}\n";
+  }
+
+  return EXIT_SUCCESS;
+}
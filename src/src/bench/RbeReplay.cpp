@@ -0,0 +1,130 @@
+/** \file
+  * rbe-replay: run the rules on a recorded track log instead of video.
+  *
+  * Feeds every frame of the log into Engine::loadObjectData and
+  * Engine::processRule as fast as possible and reports the throughput, so
+  * rules and engine changes can be evaluated on real tracker output without
+  * decoding video and background subtraction. The log is recorded by the
+  * virtual fence runner (TrackLog_enable in config.ini).
+  *
+  * Usage: rbe-replay [-c contexts.xml] [-r rules.xml] [-n repeat] [-f fps] [-s] track.log
+  *
+  * -s switches on the engine statistics and prints them at the end. The
+  * frame time of the rules is the frame number divided by fps (25).
+  *
+  * $Id$
+  */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <stdint.h>
+
+#include "src/core/Engine.hpp"
+#include "src/core/EngineStats.hpp"
+#include "src/core/TrackLog.hpp"
+
+namespace
+{
+  void usage()
+  {
+    std::cout << "Usage: rbe-replay [-c contexts.xml] [-r rules.xml] [-n repeat] [-f fps] [-s] track.log\n";
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  std::string contextFile = "./data/.temp/contexts.xml";
+  std::string ruleFile = "./data/.temp/rules.xml";
+  std::string logFile;
+  unsigned repeat = 1;
+  double fps = 25;
+  bool stats = false;
+
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if(arg == "-s")
+      stats = true;
+    else if((arg == "-c" || arg == "-r" || arg == "-n" || arg == "-f") && i + 1 < argc)
+    {
+      std::string value = argv[++i];
+      if(arg == "-c") contextFile = value;
+      else if(arg == "-r") ruleFile = value;
+      else if(arg == "-f") fps = atof(value.c_str());
+      else repeat = atoi(value.c_str());
+    }
+    else if(arg[0] != '-' && logFile.empty())
+      logFile = arg;
+    else
+    {
+      usage();
+      return arg == "-h" ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+  }
+
+  if(logFile.empty() || repeat == 0 || fps <= 0)
+  {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  Rbe::TrackLogReader reader;
+  if(!reader.open(logFile))
+  {
+    std::cout << "Error: cannot read track log " << logFile << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  Rbe::Engine engine;
+  engine.readContextFile(contextFile);
+  engine.readRuleFile(ruleFile);
+  engine.setStatsEnabled(stats);
+
+  std::vector<Rbe::TrackRecord> records;
+  // the time keeps going up over the repetitions, as the SEQUENCE windows expect
+  uint32_t logFrames = reader.getNbFrames() > 0 ? reader.getFrameNumber(reader.getNbFrames() - 1) + 1 : 0;
+  uint64_t frames = 0;
+  uint64_t objects = 0;
+  uint64_t ruleNs = 0;
+  uint64_t start = Rbe::EngineStats::now();
+
+  for(unsigned r = 0; r < repeat; r++)
+  {
+    // every repetition starts without objects, as the tracker did
+    records.clear();
+    engine.loadObjectData(records);
+    reader.rewind();
+
+    for(unsigned i = 0; i < reader.getNbFrames() && reader.next(records); i++)
+    {
+      uint64_t t0 = Rbe::EngineStats::now();
+
+      engine.loadObjectData(records);
+      engine.setFrameTime(((uint64_t)r * logFrames + reader.getFrameNumber(i)) / fps);
+      engine.processRule();
+      engine.cleanRuleEventResultQueue();
+
+      ruleNs += Rbe::EngineStats::now() - t0;
+      objects += records.size();
+      frames++;
+    }
+  }
+
+  double seconds = (Rbe::EngineStats::now() - start) / 1e9;
+
+  char line[256];
+  snprintf(line, sizeof(line), "%llu frames (%u in log), %.1f objects/frame, %.0f fps, %.0f ns/frame in the engine",
+           (unsigned long long)frames, reader.getNbFrames(),
+           frames > 0 ? (double)objects / frames : 0.0,
+           seconds > 0 ? frames / seconds : 0.0,
+           frames > 0 ? (double)ruleNs / frames : 0.0);
+  std::cout << line << std::endl;
+
+  if(stats)
+    engine.dumpStatsText(std::cout);
+
+  return EXIT_SUCCESS;
+}
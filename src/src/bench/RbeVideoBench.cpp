@@ -0,0 +1,347 @@
+/** \file
+  * rbe-videobench: end-to-end throughput of the virtual fence pipeline.
+  *
+  * Runs decode, VirtualFencing::process (background subtraction and tracking)
+  * and Engine::processRule headless over each clip, with the contexts and
+  * rules of the current project. Per clip the fps, the time split over the
+  * stages, the p50/p99 frame latency and the peak RSS are written to a JSON
+  * file. Every clip runs in a child process, so the peak RSS is that of the
+  * clip alone. Like the application it is started from the binary directory.
+  * A .y4m clip (see rbe-y4m) is read memory mapped instead of decoded, the
+  * decode stage then only measures the mapping; it must be 4:4:4. A
+  * directory clip is an image sequence, decoded ahead on -t threads.
+  *
+  * Usage: rbe-videobench [-c contexts.xml] [-r rules.xml] [-i config.ini]
+  *                       [-n maxFrames] [-t threads] [-o result.json] [clip ...]
+  *
+  * $Id$
+  */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <stdint.h>
+#include <stdexcept>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+#include <ViNotion/VideoInputVideoFile.hpp>
+#include <ViNotion/Image.hpp>
+
+#include "src/core/Engine.hpp"
+#include "src/core/EngineStats.hpp"
+#include "src/video/VideoInputY4M.hpp"
+#include "src/video/VideoInputImageSequence.hpp"
+
+#include "vinotion/VirtualFencing/VirtualFencing.hpp"
+
+namespace
+{
+  /// the measured pipeline stages.
+  enum Stage
+  {
+    STAGE_DECODE = 0,
+    STAGE_VIRTUAL_FENCING,
+    STAGE_RULES,
+    NUM_STAGES
+  };
+
+  const char *stageNames[NUM_STAGES] = {"decode", "virtual_fencing", "rules"};
+
+  /// result of one clip, plain data so a child process can pass it on.
+  struct ClipResult
+  {
+    unsigned frames;
+    unsigned width;
+    unsigned height;
+    uint64_t wallNs;
+    Rbe::LatencyHistogram stages[NUM_STAGES];
+    Rbe::LatencyHistogram frameLatency;
+    long peakRssKb;
+  };
+
+  long peakRssKb()
+  {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+  }
+
+  void runClip(ClipResult &result, const std::string &clip, const std::string &contextFile,
+               const std::string &ruleFile, const std::string &iniFile, unsigned maxFrames,
+               unsigned sequenceThreads)
+  {
+    result.frames = 0;
+
+    Rbe::Engine engine;
+    engine.readContextFile(contextFile);
+    engine.readRuleFile(ruleFile);
+
+    Vi::VideoInputVideoFile videoFile;
+    Rbe::VideoInputY4M y4mFile;
+    Rbe::VideoInputImageSequence sequence;
+    Vi::VideoInput *videoInput;
+    double frameRate;
+    if(boost::filesystem::is_directory(clip))
+    {
+      if(!sequence.open(clip, sequenceThreads))
+        throw std::runtime_error("no images in " + clip);
+      videoInput = &sequence;
+      frameRate = sequence.getFrameRate().toFloat();
+    }
+    else if(clip.size() > 4 && clip.compare(clip.size() - 4, 4, ".y4m") == 0)
+    {
+      if(!y4mFile.open(clip))
+        throw std::runtime_error("cannot open " + clip);
+      // the analysis takes the 4:4:4 frames of the decoder, a view cannot be converted in place
+      if(y4mFile.getFormat() != Vi::PF_YCC444P)
+        throw std::runtime_error(clip + " is not 4:4:4, convert it with rbe-y4m without -420");
+      videoInput = &y4mFile;
+      frameRate = y4mFile.getFrameRate().toFloat();
+    }
+    else
+    {
+      videoFile.open(clip);
+      videoFile.setLoop(false);
+      videoInput = &videoFile;
+      frameRate = videoFile.getFrameRate().toFloat();
+    }
+    result.width = videoInput->getWidth();
+    result.height = videoInput->getHeight();
+
+    VirtualFencing virtualFencing(videoInput->getWidth(), videoInput->getHeight(), iniFile);
+    virtualFencing.setEngine(&engine);
+
+    if(frameRate <= 0)
+      frameRate = 25;
+
+    Vi::Image<> currentFrame;
+    uint64_t wallStart = Rbe::EngineStats::now();
+
+    while(maxFrames == 0 || result.frames < maxFrames)
+    {
+      uint64_t t0 = Rbe::EngineStats::now();
+      if(!videoInput->read(currentFrame))
+        break;
+      uint64_t t1 = Rbe::EngineStats::now();
+
+      virtualFencing.process(currentFrame, result.frames);
+      uint64_t t2 = Rbe::EngineStats::now();
+
+      engine.setFrameTime(result.frames / frameRate);
+      engine.processRule();
+      engine.cleanRuleEventResultQueue();
+      uint64_t t3 = Rbe::EngineStats::now();
+
+      result.stages[STAGE_DECODE].record(t1 - t0);
+      result.stages[STAGE_VIRTUAL_FENCING].record(t2 - t1);
+      result.stages[STAGE_RULES].record(t3 - t2);
+      result.frameLatency.record(t3 - t0);
+
+      result.frames++;
+    }
+
+    result.wallNs = Rbe::EngineStats::now() - wallStart;
+    result.peakRssKb = peakRssKb();
+  }
+
+  /// run the clip in a child process, so its peak RSS is not that of an earlier clip.
+  void runClipIsolated(ClipResult &result, const std::string &clip, const std::string &contextFile,
+                       const std::string &ruleFile, const std::string &iniFile, unsigned maxFrames,
+                       unsigned sequenceThreads)
+  {
+    int fds[2];
+    pid_t pid = pipe(fds) == 0 ? fork() : -1;
+    if(pid == 0)
+    {
+      close(fds[0]);
+      try
+      {
+        runClip(result, clip, contextFile, ruleFile, iniFile, maxFrames, sequenceThreads);
+      }
+      catch (const std::exception &e)
+      {
+        std::cout << "Error: " << e.what() << std::endl;
+        _exit(EXIT_FAILURE);
+      }
+
+      const char *data = (const char *)&result;
+      size_t left = sizeof(result);
+      while(left > 0)
+      {
+        ssize_t written = write(fds[1], data, left);
+        if(written <= 0)
+          _exit(EXIT_FAILURE);
+        data += written;
+        left -= written;
+      }
+      _exit(EXIT_SUCCESS);
+    }
+    if(pid < 0)
+    {
+      std::cout << "Warning: cannot fork, the peak RSS is that of the process" << std::endl;
+      runClip(result, clip, contextFile, ruleFile, iniFile, maxFrames, sequenceThreads);
+      return;
+    }
+
+    // the result is larger than a pipe write, it comes in pieces
+    close(fds[1]);
+    char *data = (char *)&result;
+    size_t left = sizeof(result);
+    while(left > 0)
+    {
+      ssize_t got = read(fds[0], data, left);
+      if(got <= 0)
+        break;
+      data += got;
+      left -= got;
+    }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if(left > 0)
+      throw std::runtime_error("the benchmark of " + clip + " failed");
+  }
+
+  void writeLatency(std::ostream &out, const Rbe::LatencyHistogram &histogram)
+  {
+    out << "{\"mean_us\":" << histogram.getMean() / 1000.0
+        << ",\"p50_us\":" << histogram.getPercentile(50) / 1000.0
+        << ",\"p99_us\":" << histogram.getPercentile(99) / 1000.0
+        << ",\"max_us\":" << histogram.getMax() / 1000.0 << "}";
+  }
+
+  void writeJson(std::ostream &out, const std::vector<std::string> &clips, const std::vector<ClipResult *> &results)
+  {
+    out << "{\"clips\":[";
+    for(unsigned i = 0; i < results.size(); i++)
+    {
+      const ClipResult &r = *results[i];
+      double seconds = r.wallNs / 1e9;
+
+      uint64_t stageTotal = 0;
+      for(unsigned s = 0; s < NUM_STAGES; s++)
+        stageTotal += r.stages[s].getSum();
+
+      out << (i > 0 ? "," : "") << "\n{\"clip\":\"" << clips[i] << "\""
+          << ",\"width\":" << r.width
+          << ",\"height\":" << r.height
+          << ",\"frames\":" << r.frames
+          << ",\"seconds\":" << seconds
+          << ",\"fps\":" << (seconds > 0 ? r.frames / seconds : 0.0)
+          << ",\"peak_rss_kb\":" << r.peakRssKb
+          << ",\"frame_latency\":";
+      writeLatency(out, r.frameLatency);
+
+      out << ",\"stages\":{";
+      for(unsigned s = 0; s < NUM_STAGES; s++)
+      {
+        out << (s > 0 ? "," : "") << "\"" << stageNames[s] << "\":{"
+            << "\"total_ms\":" << r.stages[s].getSum() / 1e6
+            << ",\"share\":" << (stageTotal > 0 ? (double)r.stages[s].getSum() / stageTotal : 0.0)
+            << ",\"latency\":";
+        writeLatency(out, r.stages[s]);
+        out << "}";
+      }
+      out << "}}";
+    }
+    out << "\n]}\n";
+  }
+
+  void usage()
+  {
+    std::cout << "Usage: rbe-videobench [-c contexts.xml] [-r rules.xml] [-i config.ini]\n"
+              << "                      [-n maxFrames] [-t threads] [-o result.json] [clip ...]\n";
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  std::string contextFile = "./data/.temp/contexts.xml";
+  std::string ruleFile = "./data/.temp/rules.xml";
+  std::string iniFile = "./data/.temp/VirtualFence/config.ini";
+  std::string outputFile = "./videobench.json";
+  unsigned maxFrames = 0;
+  unsigned sequenceThreads = 0;
+  std::vector<std::string> clips;
+
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if(arg == "-h" || arg == "--help")
+    {
+      usage();
+      return EXIT_SUCCESS;
+    }
+    if(arg.size() == 2 && arg[0] == '-')
+    {
+      if(i + 1 >= argc)
+      {
+        usage();
+        return EXIT_FAILURE;
+      }
+      std::string value = argv[++i];
+      if(arg == "-c") contextFile = value;
+      else if(arg == "-r") ruleFile = value;
+      else if(arg == "-i") iniFile = value;
+      else if(arg == "-n") maxFrames = atoi(value.c_str());
+      else if(arg == "-t") sequenceThreads = atoi(value.c_str());
+      else if(arg == "-o") outputFile = value;
+      else
+      {
+        usage();
+        return EXIT_FAILURE;
+      }
+    }
+    else
+      clips.push_back(arg);
+  }
+
+  // the clips shipped with the binary
+  if(clips.empty())
+  {
+    clips.push_back("./data/video/cross_road.avi");
+    clips.push_back("./data/video/park.avi");
+    clips.push_back("./other-videos/pets2000.avi");
+    clips.push_back("./other-videos/pets2001.avi");
+  }
+
+  std::vector<ClipResult *> results;
+  try
+  {
+    for(unsigned i = 0; i < clips.size(); i++)
+    {
+      ClipResult *result = new ClipResult();
+      runClipIsolated(*result, clips[i], contextFile, ruleFile, iniFile, maxFrames, sequenceThreads);
+      results.push_back(result);
+
+      char line[256];
+      snprintf(line, sizeof(line), "%-32s %6u frames %8.1f fps  p50 %8.2f ms  p99 %8.2f ms  peak %ld kB",
+               clips[i].c_str(), result->frames,
+               result->wallNs > 0 ? result->frames / (result->wallNs / 1e9) : 0.0,
+               result->frameLatency.getPercentile(50) / 1e6,
+               result->frameLatency.getPercentile(99) / 1e6,
+               result->peakRssKb);
+      std::cout << line << std::endl;
+    }
+  }
+  catch (const std::exception &e)
+  {
+    std::cout << "Error: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::ofstream json(outputFile.c_str());
+  writeJson(json, clips, results);
+
+  for(unsigned i = 0; i < results.size(); i++)
+    delete results[i];
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,146 @@
+/** \file
+  * rbe-y4m: convert a clip to an uncompressed .y4m file.
+  *
+  * Decodes the clip once and writes its frames as they come out of the
+  * decoder, so rbe-videobench can read them memory mapped (VideoInputY4M)
+  * and measure the analysis without the decoding. The frames are kept 4:4:4
+  * like the decoder delivers them, which is what the analysis takes; -420
+  * halves the chroma to make the file half the size, rbe-videobench does
+  * not take such files. Like the application it is started from the binary
+  * directory.
+  *
+  * Usage: rbe-y4m [-420] [-n maxFrames] clip [out.y4m]
+  *
+  * Without out.y4m the clip name with the extension .y4m is used.
+  *
+  * $Id$
+  */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+#include <stdint.h>
+
+#include <ViNotion/VideoInputVideoFile.hpp>
+#include <ViNotion/Image.hpp>
+
+#include "src/video/VideoInputY4M.hpp"
+
+namespace
+{
+  /// halve the chroma of a 4:4:4 frame by averaging 2x2 blocks.
+  void toYcc420(const Vi::Image<> &frame, Vi::Image<> &result)
+  {
+    if(result.fmt() != Vi::PF_YCC420P)
+      result.fmt(Vi::PF_YCC420P);
+    if(result.w() != frame.w() || result.h() != frame.h())
+      result.resize(frame.w(), frame.h());
+
+    for(unsigned y = 0; y < frame.h(); y++)
+      std::copy(frame.Y(y), frame.Y(y) + frame.w(), result.Y(y));
+
+    for(unsigned y = 0; y < frame.h() / 2; y++)
+    {
+      const uint8_t *cb0 = frame.Cb(2 * y);
+      const uint8_t *cb1 = frame.Cb(2 * y + 1);
+      const uint8_t *cr0 = frame.Cr(2 * y);
+      const uint8_t *cr1 = frame.Cr(2 * y + 1);
+      uint8_t *cb = result.Cb(y);
+      uint8_t *cr = result.Cr(y);
+      for(unsigned x = 0; x < frame.w() / 2; x++)
+      {
+        cb[x] = (cb0[2 * x] + cb0[2 * x + 1] + cb1[2 * x] + cb1[2 * x + 1] + 2) / 4;
+        cr[x] = (cr0[2 * x] + cr0[2 * x + 1] + cr1[2 * x] + cr1[2 * x + 1] + 2) / 4;
+      }
+    }
+  }
+
+  void usage()
+  {
+    std::cout << "Usage: rbe-y4m [-420] [-n maxFrames] clip [out.y4m]\n";
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  bool subsample = false;
+  unsigned maxFrames = 0;
+  std::vector<std::string> files;
+
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if(arg == "-420")
+      subsample = true;
+    else if(arg == "-n" && i + 1 < argc)
+      maxFrames = atoi(argv[++i]);
+    else if(arg[0] != '-' && files.size() < 2)
+      files.push_back(arg);
+    else
+    {
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+
+  if(files.empty())
+  {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  std::string clip = files[0];
+  std::string outputFile = files.size() > 1 ? files[1] : clip.substr(0, clip.rfind('.')) + ".y4m";
+
+  unsigned frames = 0;
+  try
+  {
+    Vi::VideoInputVideoFile videoInput;
+    videoInput.open(clip);
+    videoInput.setLoop(false);
+
+    Vi::Frac<int> frameRate = videoInput.getFrameRate();
+    if(frameRate.mNum <= 0 || frameRate.mDen <= 0)
+      frameRate = Vi::Frac<int>(25);
+
+    std::ofstream out(outputFile.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!out.is_open() ||
+       !Rbe::writeY4MHeader(out, videoInput.getWidth(), videoInput.getHeight(),
+                            subsample ? Vi::PF_YCC420P : Vi::PF_YCC444P, frameRate))
+    {
+      std::cout << "Error: cannot write " << outputFile << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    Vi::Image<> frame;
+    Vi::Image<> subsampled(Vi::PF_YCC420P);
+    while((maxFrames == 0 || frames < maxFrames) && videoInput.read(frame))
+    {
+      if(subsample)
+      {
+        toYcc420(frame, subsampled);
+        Rbe::writeY4MFrame(out, subsampled);
+      }
+      else
+        Rbe::writeY4MFrame(out, frame);
+      frames++;
+    }
+
+    if(!out.good())
+    {
+      std::cout << "Error: cannot write " << outputFile << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  catch (const std::exception &e)
+  {
+    std::cout << "Error: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << clip << ": " << frames << " frames written to " << outputFile << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -5,8 +5,6 @@ using namespace Rbe;
 Action::Action(ActionType type)
 {
   mType = type;
-  mAlarmSound = new QSound("./data/.temp/sound/alarm.wav");
-  mAlarmSound->play();
 }
 
 Action::Action(std::string type)
@@ -15,12 +13,6 @@ Action::Action(std::string type)
   else if(type == "ALARM") mType = ALARM;
   else if(type == "DISABLE") mType = DISABLE;
   else assert(false);
-  
-  QString path = QApplication::applicationDirPath() + "/data/.temp/sound/alarm.wav";
-  ///home/dai/Dropbox/Graduation/rulebasedengine/build/data/.temp/sound/alarm.wav
-  mAlarmSound = new QSound(path );
-  bool playable = mAlarmSound->isAvailable();
-  //mAlarmSound->play();
 }
 
 
@@ -30,27 +22,23 @@ void Action::performAction()
   
   if(mType == PRINT) 
   {
-    std::cout << mMessage.toStdString() << "  " <<a <<"\n";
+    std::cout << mMessage << "  " <<a <<"\n";
     
-    //qDebug() << mMessage << "" << a;;
   }  
   
   if(mType == ALARM) 
   {
-   // mAlarmSound->play(); not functional
-    std::cout << mMessage.toStdString() <<  "  "  << a <<"\n";
-    
-   // qDebug() << mMessage << a;;
+    //there is no sound output in the core, the alarm is printed
+    std::cout << mMessage <<  "  "  << a <<"\n";
   }  
   a++;
 }
 
-void Action::setMessage(QString message)
+void Action::setMessage(std::string message)
 {
   mMessage = message;
 }
 
 Action::~Action()
 {
-  delete mAlarmSound;
 }
@@ -12,11 +12,6 @@
 #include <iostream>
 #include <assert.h>
 
-#include <QSound>
-#include <QString>
-#include <QApplication>
-#include <QDebug>
-
 namespace Rbe
 {
 
@@ -57,7 +52,7 @@ public:
   /**
     * set the message to be printed
     */
-  void setMessage(QString message);
+  void setMessage(std::string message);
       
   /**
     * run the action
@@ -67,8 +62,7 @@ public:
   
 private:    
   ActionType mType;     ///< instance of ActionType enum
-  QSound *mAlarmSound;  
-  QString mMessage;
+  std::string mMessage;
 };
 
 }
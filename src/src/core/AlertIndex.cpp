@@ -0,0 +1,102 @@
+#include "AlertIndex.hpp"
+
+#include "Rule.hpp"
+#include "EventContainer.hpp"
+#include "Event.hpp"
+#include "Misc.hpp"
+
+using namespace Rbe;
+
+void AlertIndex::build(const std::vector<Rule *> &rules)
+{
+  clear();
+  
+  for(unsigned i = 0; i < rules.size(); i++)
+    addContainer(rules[i], rules[i]->getEventContainer());
+}
+
+void AlertIndex::addContainer(Rule *rule, EventContainer *container)
+{
+  for(unsigned i = 0; i < container->mContainers.size(); i++)
+    addContainer(rule, container->mContainers[i]);
+  
+  // only the event entries carry object ids, container entries have none
+  for(unsigned k = 0; k < container->mResultQueue.size(); k++)
+  {
+    const QueueStruct &entry = container->mResultQueue[k];
+    if(entry.result == false || entry.eventSource == NULL)
+      continue;
+    
+    for(unsigned l = 0; l < entry.objectsID.size(); l++)
+    {
+      Alert &alert = insert(entry.objectsID[l]);
+      alert.rule = rule;
+      alert.event = entry.eventSource;
+      alert.contextId = entry.contextID;
+    }
+  }
+}
+
+void AlertIndex::clear()
+{
+  // only the used slots are reset, the table keeps its size
+  for(unsigned i = 0; i < mAlerts.size(); i++)
+  {
+    unsigned slot = slotOf(mAlerts[i].objectId);
+    while(mSlots[slot] != 0)
+    {
+      mSlots[slot] = 0;
+      slot = (slot + 1) & (mSlots.size() - 1);
+    }
+  }
+  mAlerts.clear();
+}
+
+const Alert *AlertIndex::find(int objectId) const
+{
+  if(mSlots.empty())
+    return NULL;
+  
+  unsigned slot = slotOf(objectId);
+  while(mSlots[slot] != 0)
+  {
+    const Alert &alert = mAlerts[mSlots[slot] - 1];
+    if(alert.objectId == objectId)
+      return &alert;
+    slot = (slot + 1) & (mSlots.size() - 1);
+  }
+  return NULL;
+}
+
+Alert &AlertIndex::insert(int objectId)
+{
+  // keep the table at most half full
+  if(2 * (mAlerts.size() + 1) > mSlots.size())
+    rehash(mSlots.empty() ? 64 : 2 * mSlots.size());
+  
+  unsigned slot = slotOf(objectId);
+  while(mSlots[slot] != 0)
+  {
+    Alert &alert = mAlerts[mSlots[slot] - 1];
+    if(alert.objectId == objectId)
+      return alert;
+    slot = (slot + 1) & (mSlots.size() - 1);
+  }
+  
+  mAlerts.push_back(Alert());
+  mAlerts.back().objectId = objectId;
+  mSlots[slot] = mAlerts.size();
+  return mAlerts.back();
+}
+
+void AlertIndex::rehash(unsigned nbSlots)
+{
+  mSlots.assign(nbSlots, 0);
+  for(unsigned i = 0; i < mAlerts.size(); i++)
+  {
+    unsigned slot = slotOf(mAlerts[i].objectId);
+    while(mSlots[slot] != 0)
+      slot = (slot + 1) & (mSlots.size() - 1);
+    mSlots[slot] = i + 1;
+  }
+}
@@ -0,0 +1,81 @@
+/** \file
+  * The per frame alert index: which tracked objects triggered an event in
+  * the last Engine::processRule call, and by which rule, event and context.
+  *
+  * $Id$
+  */
+
+#ifndef ALERTINDEX_HPP
+#define ALERTINDEX_HPP
+
+#include <vector>
+#include <cstddef>
+
+namespace Rbe
+{
+  class Rule;
+  class Event;
+  class EventContainer;
+
+  /**
+    * One alerted object.
+    */
+  struct Alert
+  {
+    Alert() : objectId(-1), rule(NULL), event(NULL), contextId(-1) {}
+
+    int objectId;   ///< id of the tracked object.
+    Rule *rule;     ///< the rule the event belongs to.
+    Event *event;   ///< the event that reported the object.
+    int contextId;  ///< id of the crossed tripwire, -1 for other events.
+  };
+
+  /**
+    * Object id to alert map of one frame, rebuilt by the engine after the
+    * rules are processed. When several events report the same object the
+    * one of the last rule is kept.
+    *
+    * The alerts are kept in a vector with an open addressing hash table of
+    * indices next to it. Both are reused from frame to frame, so rebuilding
+    * the index does not allocate once the largest frame has been seen.
+    */
+  class AlertIndex
+  {
+  public:
+    typedef std::vector<Alert>::const_iterator const_iterator;
+
+    /**
+      * Rebuild the index from the result queues of the rules.
+      *
+      * \param[in] rules the rules of the engine, after processing a frame.
+      */
+    void build(const std::vector<Rule *> &rules);
+
+    /// Remove all alerts.
+    void clear();
+
+    /**
+      * Look up an object.
+      *
+      * \param[in] objectId id of the tracked object.
+      * \return the alert, NULL if the object triggered nothing this frame.
+      */
+    const Alert *find(int objectId) const;
+
+    inline bool empty() const {return mAlerts.empty();}
+    inline unsigned size() const {return mAlerts.size();}
+    inline const_iterator begin() const {return mAlerts.begin();}
+    inline const_iterator end() const {return mAlerts.end();}
+
+  private:
+    void addContainer(Rule *rule, EventContainer *container);
+    Alert &insert(int objectId);
+    void rehash(unsigned nbSlots);
+    inline unsigned slotOf(int objectId) const {return ((unsigned)objectId * 2654435761u) & (mSlots.size() - 1);}
+
+    std::vector<Alert> mAlerts;   ///< the alerts, in order of insertion.
+    std::vector<unsigned> mSlots; ///< index + 1 in mAlerts, 0 for an empty slot; size is a power of two.
+  };
+}
+
+#endif // ALERTINDEX_HPP
@@ -18,3 +18,9 @@ Context::~Context()
 {
 }
 
+Rect Context::getBounds()
+{
+  Rect empty = {0, 0, 0, 0};
+  return empty;
+}
+
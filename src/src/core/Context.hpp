@@ -8,8 +8,8 @@
 #define CONTEXT_H
 
 #include <string>
-#include <ViNotion/Image.hpp>
-#include <ViNotion/ImageFile.hpp>
+
+#include "Misc.hpp"
 
 
 namespace Rbe
@@ -90,6 +90,13 @@ namespace Rbe
       */
     inline void setDesc(std::string desc){mDesc = desc;}    
     
+    /**
+      * Bounding box of the context in frame coordinates.
+      *
+      * \return the box, empty if the context covers no pixel.
+      */
+    virtual Rect getBounds();
+    
     
   protected:
     
@@ -1,29 +1,78 @@
 #include "ContextArea.hpp"
 
+#include <algorithm>
+#include <climits>
+
 using namespace Rbe;
 
 ContextArea::ContextArea()
 {    
   mType = Context::AREA;
+  mImage = NULL;
+  mBoundsValid = false;
 }
 
 ContextArea::ContextArea(int id, Context::ContextType type, std::string name, std::string desc):Context(id,type,name,desc)
 {  
+  mImage = NULL;
+  mBoundsValid = false;
 }
 
-void ContextArea::setQImage(std::string filePath)
+void ContextArea::setMaskImage(std::string filePath)
 {
-  QString path = QString::fromStdString(filePath);
-  mImage = new QImage(path);  
+  delete mImage;
+  mImage = new Raster();
+  mBoundsValid = false;
+  
+  //an unreadable mask leaves an empty raster, no pixel matches the area color
+  if(!mImage->loadPng(filePath))
+    std::cout << "Error: ContextArea::setMaskImage --> cannot read " << filePath << std::endl;
 }
 
 void ContextArea::setColor(int r, int g, int b, int a)
 {
-  mColor =  QColor(r,g,b,a);
+  mColor = Color(r,g,b,a);
+  mBoundsValid = false;
+}
+
+Rect ContextArea::getBounds()
+{
+  if(mBoundsValid)
+    return mBounds;
+  
+  int x0 = INT_MAX, y0 = INT_MAX, x1 = -1, y1 = -1;
+  Rgb color = mColor.rgba();
+  
+  for(unsigned y = 0; mImage != NULL && y < mImage->getHeight(); y++)
+  {
+    const Rgb *line = mImage->scanLine(y);
+    for(unsigned x = 0; x < mImage->getWidth(); x++)
+    {
+      if(line[x] != color)
+        continue;
+      x0 = std::min(x0, (int)x);
+      x1 = std::max(x1, (int)x);
+      y0 = std::min(y0, (int)y);
+      y1 = y;
+    }
+  }
+  
+  if(x1 < 0)
+  {
+    mBounds.x = mBounds.y = mBounds.width = mBounds.height = 0;
+  }
+  else
+  {
+    mBounds.x = x0;
+    mBounds.y = y0;
+    mBounds.width = x1 - x0 + 1;
+    mBounds.height = y1 - y0 + 1;
+  }
+  mBoundsValid = true;
+  return mBounds;
 }
 
 ContextArea::~ContextArea()
 {
   delete mImage;
 }
-
@@ -10,13 +10,8 @@
 
 #include <iostream>
 #include "Context.hpp"
-#include <QImage>
-#include <QColor>
-#include <QString>
-#include <QRgb>
-
-#include <ViNotion/Image.hpp>
-#include <ViNotion/ImageFile.hpp>
+#include "Misc.hpp"
+#include "Raster.hpp"
 
 namespace Rbe
 {
@@ -64,14 +59,14 @@ namespace Rbe
     
     /**
       * set mask image.
-      * \param[in] filePath the path of image file.
+      * \param[in] filePath the path of the PNG image file.
       */
-    void setQImage(std::string filePath);    
+    void setMaskImage(std::string filePath);    
     
     /**
       * get mask image.      
       */
-    QImage* getQImage(){return mImage;}
+    Raster* getMaskImage(){return mImage;}
     
     /**
       * set color of the area.
@@ -85,18 +80,26 @@ namespace Rbe
     /**
       * get area color.
       */
-    QColor getColor(){return mColor;}
+    Color getColor(){return mColor;}
+    
+    /**
+      * get the area color as 0xAARRGGBB, to compare with mask pixels.
+      */
+    Rgb getRgbColorValue(){return mColor.rgba();}
     
     /**
-      * get the QRbg qt type from the area color.
+      * bounding box of the mask pixels with the area color, computed on the
+      * first call after the mask or color changed.
       */
-    QRgb getRgbColorValue(){return mColor.rgba();}
+    Rect getBounds();
     
   private:
     
     std::string mMaskFilePath; ///< path the mask image.        
-    QImage *mImage;  ///< Mask image (use QImage class).        
-    QColor mColor;  ///< Color of the area (use for event detection)
+    Raster *mImage;  ///< Mask image.        
+    Color mColor;  ///< Color of the area (use for event detection)
+    Rect mBounds;  ///< cached bounding box.
+    bool mBoundsValid;
   };
 }
 #endif // CONTEXTAREA_HPP
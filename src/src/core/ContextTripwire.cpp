@@ -1,5 +1,7 @@
 #include "ContextTripwire.hpp"
 
+#include <algorithm>
+
 
 using namespace Rbe;
 ContextTripwire::ContextTripwire()
@@ -22,6 +24,16 @@ Line* ContextTripwire::getLine()
   return &mLine;
 }
 
+Rect ContextTripwire::getBounds()
+{
+  Rect bounds;
+  bounds.x = std::min(mLine.point1.x, mLine.point2.x);
+  bounds.y = std::min(mLine.point1.y, mLine.point2.y);
+  bounds.width = std::max(mLine.point1.x, mLine.point2.x) - bounds.x + 1;
+  bounds.height = std::max(mLine.point1.y, mLine.point2.y) - bounds.y + 1;
+  return bounds;
+}
+
 ContextTripwire::~ContextTripwire()
 {  
 }
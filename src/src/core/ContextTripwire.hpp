@@ -56,6 +56,9 @@ namespace Rbe
       */
     Line* getLine();
     
+    /// bounding box of the line.
+    Rect getBounds();
+    
   private:           
     Line mLine;  ///< tripwire line.
   };
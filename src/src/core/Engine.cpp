@@ -10,14 +10,21 @@
 #include "Event.hpp"
 #include "EventContainer.hpp"
 #include "Misc.hpp"
-
-#include "vinotion/VirtualFencing/TrackedObjectVirtualFencing.hpp"
+#include "TrackLog.hpp"
 
 using namespace Rbe;
 
+namespace
+{
+  /// trajectory points kept per replayed object, like the tracker keeps
+  /// (the events use at most the last 5).
+  const unsigned REPLAY_TRAJECTORY_LENGTH = 20;
+}
+
 Engine::Engine()
 { 
  maskPath = "";
+ mFrameTime = 0;
 }
 
 
@@ -261,7 +268,7 @@ void Engine::loadXmlActionType(xmlNodePtr node, EventContainer *eContainer, Even
         std::string type = (char*)xmlGetProp(nodeAction,(const xmlChar*)"type");
         std::string value = (char*)xmlGetProp(nodeAction,(const xmlChar*)"value");
         Action *aAction = new Action(type);        
-        aAction->setMessage(QString::fromStdString(value));
+        aAction->setMessage(value);
         
         if(eContainer != NULL)
         {
@@ -322,7 +329,7 @@ void Engine::loadXmlContextType(xmlNodePtr node)
           ContextArea *aContext = new ContextArea(id,type,name,desc);
           //set mask image
           aContext->setMaskFilePath(maskPath);          
-          aContext->setQImage(maskPath);
+          aContext->setMaskImage(maskPath);
           
           //get color
           xmlNodePtr nodeInsideContext = nodeContext->children;                            
@@ -413,88 +420,61 @@ void Engine::loadXMLMaskType(std::string &maskFileName, xmlNodePtr node)
 
 
 
-void Engine::loadObjectDataFromVirtualFence(std::vector<TrackedObjectVirtualFencing> &mTracksVF)
+void Engine::loadObjectData(const std::vector<TrackRecord> &records)
 {
-  if(mTracksVF.size() == 0)
-    mObjects.clear();
-  
-  if(mTracksVF.size() > 0)
+  //remove objects that are not tracked anymore
+  for(unsigned i = mObjects.size(); i-- > 0;)
   {
-    if(mObjects.size() == 0)
+    bool tracked = false;
+    for(unsigned j = 0; j < records.size(); j++)
     {
-      for(int i = 0 ; i < mTracksVF.size();i++)
+      if(records[j].id == mObjects[i]->getId())
       {
-        TrackedObjectVirtualFencing *trackV = &mTracksVF[i];
-        Object *newObject = new Object();
-        newObject->setId(trackV->mID);
-        trackV->setCurrentObjectFrame(newObject);
-        trackV->updateRbeObjectFrame(newObject);
-        trackV->updateRbeTrajectory(newObject);
-        
-        mObjects.push_back(newObject);
+        tracked = true;
+        break;
       }
     }
     
-    else if(mObjects.size() > 0)
+    if(!tracked)
     {
-      //update and add new
-      if(mObjects.size() <= mTracksVF.size())
-      {
-        for(int i = 0; i < mTracksVF.size(); i++)
-        {
-          TrackedObjectVirtualFencing *trackV = &mTracksVF[i];
-          
-          if(isObjectExist(trackV->mID))
-          {
-            //update                        
-            Object *newObject = mObjects[i];
-            trackV->setCurrentObjectFrame(newObject);
-            trackV->updateRbeObjectFrame(newObject);
-            trackV->updateRbeTrajectory(newObject);
-            
-          }
-          else
-          {
-            //add new 
-            Object *newObject = new Object();
-            newObject->setId(trackV->mID);
-            trackV->setCurrentObjectFrame(newObject);
-            trackV->updateRbeObjectFrame(newObject);
-            trackV->updateRbeTrajectory(newObject);
-            
-            mObjects.push_back(newObject);
-          }
-        }
-      }
-      
-      //remove
-      else if(mObjects.size() > mTracksVF.size())
+      delete mObjects[i];
+      mObjects.erase(mObjects.begin() + i);
+    }
+  }
+  
+  //update and add new
+  for(unsigned j = 0; j < records.size(); j++)
+  {
+    const TrackRecord &record = records[j];
+    
+    Object *object = NULL;
+    for(unsigned i = 0; i < mObjects.size(); i++)
+    {
+      if(mObjects[i]->getId() == record.id)
       {
-        for(int i = 0; i < mObjects.size(); i++)
-        {
-          Object *newObject = mObjects[i];
-          int objectID = newObject->getId();
-          
-          bool value = false;
-          for(int j = 0; j < mTracksVF.size(); j++)
-          {
-             TrackedObjectVirtualFencing *trackV = &mTracksVF[j];
-             int trackId = trackV->mID;
-             if(trackId == objectID)
-             {
-               value = true;               
-               break;
-             }             
-          }
-          
-          //remove if false
-          if(value == false)
-          {
-            mObjects.erase(mObjects.begin()+i);
-          }
-        }
+        object = mObjects[i];
+        break;
       }
     }
+    
+    if(object == NULL)
+    {
+      object = new Object();
+      object->setId(record.id);
+      mObjects.push_back(object);
+    }
+    
+    ObjectFrame *frame = object->getCurrentObjectFrame();
+    frame->setX(record.x);
+    frame->setY(record.y);
+    frame->setWidth(record.width);
+    frame->setHeight(record.height);
+    
+    Point p;
+    p.x = record.pointX;
+    p.y = record.pointY;
+    object->addTrajectory(p);
+    object->trimTrajectory(REPLAY_TRAJECTORY_LENGTH);
   }
 }
 
@@ -617,12 +597,31 @@ bool Engine::isNewObject(int aID)
 
 void Engine::processRule()
 {
+  ScopedEvalTimer timer(mFrameStats);
+  bool fired = false;
+  FrameContext frame(mContexts,mObjects,mAnalysis,mFrameTime);
+  
   for(uint i = 0; i < mRules.size(); i++ )
   {
     Rule *aRule = mRules[i];
+    uint64_t firesBefore = aRule->getStats().fires;
     
-    aRule->process(mContexts,mObjects);
+    aRule->process(frame);
+    
+    if(aRule->getStats().fires != firesBefore)
+      fired = true;
   }
+  
+  mAlerts.build(mRules);
+  
+  if(fired)
+    mFrameStats.fires++;
+}
+
+void Engine::resetStats()
+{
+  mFrameStats.reset();
+  EngineStats::reset(mRules);
 }
 
 
@@ -644,6 +643,7 @@ void Engine::clear()
   mContexts.clear();
   mObjects.clear();
   mRules.clear();
+  mAlerts.clear();
 }
 
 Engine::~Engine()
@@ -20,7 +20,9 @@
 #include <libxml/xpath.h>
 #include <libxml/xpathInternals.h>
 
-#include <QString>
+#include "EngineStats.hpp"
+#include "AlertIndex.hpp"
+#include "Misc.hpp"
 
 class TrackedObjectVirtualFencing;
 
@@ -36,6 +38,7 @@ struct Point;
 struct Line;
 class Action;
 class ObjectFrame;
+struct TrackRecord;
 
 /**
     * Engine class, responsile for loading data from xml file and process rules
@@ -66,20 +69,82 @@ public:
   */
   void loadObjectDataFromVirtualFence(std::vector<TrackedObjectVirtualFencing> &mTracksVFs);
   
+/**
+  * take object data from a track log frame: objects are matched by id,
+  * updated with the bbox, get the trajectory point appended, new ids are
+  * added and objects without a record are removed.
+  */
+  void loadObjectData(const std::vector<TrackRecord> &records);
   
-  std::vector<Context *> getContexts(){return mContexts;}
-  std::vector<Object *> getObjects(){return mObjects;}               
-  std::vector<Rule *> getRules(){return mRules;}               
+  
+/**
+  * Read-only views on the engine content, valid until the next load or clear.
+  */
+  const std::vector<Context *> &getContexts() const {return mContexts;}
+  const std::vector<Object *> &getObjects() const {return mObjects;}
+  const std::vector<Rule *> &getRules() const {return mRules;}
   
   void readContextFile(std::string fileName);        
   void readRuleFile(std::string fileName);        
   
+/**
+  * Add a context, rule or object built in code instead of read from xml
+  * (e.g. by a benchmark or a replay tool). The engine keeps the pointer.
+  */
+  void addContext(Context *context){mContexts.push_back(context);}
+  void addRule(Rule *rule){mRules.push_back(rule);}
+  void addObject(Object *object){mObjects.push_back(object);}
+  
   //detection           
   void processRule();    
+  
+/**
+  * Time of the next processed frame in the input, in seconds. SEQUENCE
+  * windows are measured in this time, so they do not depend on how fast
+  * or how many frames are processed.
+  */
+  void setFrameTime(double seconds){mFrameTime = seconds;}
+  double getFrameTime() const {return mFrameTime;}
+  
+/**
+  * Position in the frame and downscale factor of the image the objects were
+  * tracked on, when the tracker runs on a crop or a smaller copy of the
+  * frame. Contexts stay in frame coordinates.
+  */
+  void setAnalysisOffset(int x, int y){mAnalysis.offset.x = x; mAnalysis.offset.y = y;}
+  void setAnalysisScale(int scale){mAnalysis.scale = scale;}
+  const AnalysisTransform &getAnalysis() const {return mAnalysis;}
+  
+/**
+  * The objects that triggered an event in the last processRule() call,
+  * valid until the next processRule() or clear().
+  */
+  const AlertIndex &getAlerts() const {return mAlerts;}
+  
   void cleanRuleEventResultQueue();
   void clear();
   
   std::string getMaskPath(){return maskPath;}
+  
+/**
+  * Switch the per rule, container and event statistics on or off. 
+  * Statistics are off by default and then cost a single flag test per item.
+  */
+  void setStatsEnabled(bool enabled){EngineStats::setEnabled(enabled);}
+  bool isStatsEnabled(){return EngineStats::isEnabled();}
+  
+/**
+  * Statistics of the processRule() call as a whole, one sample per frame.
+  */
+  const EvalStats &getFrameStats(){return mFrameStats;}
+  
+/**
+  * Write the statistics of all rules as text or as JSON.
+  */
+  void dumpStatsText(std::ostream &out){EngineStats::dumpText(out,mRules,mFrameStats);}
+  void dumpStatsJson(std::ostream &out){EngineStats::dumpJson(out,mRules,mFrameStats);}
+  void resetStats();
+  
 private:
   
   std::vector<Rule *> mRules;
@@ -87,6 +152,10 @@ private:
   std::vector<Object *> mObjects;       
   
   std::string maskPath;
+  EvalStats mFrameStats;
+  AlertIndex mAlerts;
+  AnalysisTransform mAnalysis;
+  double mFrameTime;
   
   bool isNewObject(int id);
   
@@ -0,0 +1,332 @@
+#include "EngineStats.hpp"
+
+#include <time.h>
+#include <sstream>
+#include <map>
+
+#include "Rule.hpp"
+#include "EventContainer.hpp"
+#include "Event.hpp"
+
+using namespace Rbe;
+
+bool EngineStats::sEnabled = false;
+
+LatencyHistogram::LatencyHistogram()
+{
+  reset();
+}
+
+unsigned LatencyHistogram::bucketIndex(uint64_t value)
+{
+  if(value < SUB_BUCKETS)
+    return (unsigned)value;
+
+  unsigned exponent = 63 - __builtin_clzll(value);
+  unsigned sub = (unsigned)(value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+
+  return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(unsigned index)
+{
+  if(index < SUB_BUCKETS)
+    return index;
+
+  unsigned group = index / SUB_BUCKETS;
+  unsigned sub = index % SUB_BUCKETS;
+  unsigned shift = group - 1;
+  uint64_t lower = ((uint64_t)(SUB_BUCKETS + sub)) << shift;
+
+  return lower + (((uint64_t)1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value)
+{
+  mBuckets[bucketIndex(value)]++;
+  mCount++;
+  mSum += value;
+
+  if(value < mMin)
+    mMin = value;
+  if(value > mMax)
+    mMax = value;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+  for(unsigned i = 0; i < NUM_BUCKETS; i++)
+    mBuckets[i] += other.mBuckets[i];
+
+  mCount += other.mCount;
+  mSum += other.mSum;
+
+  if(other.mCount > 0 && other.mMin < mMin)
+    mMin = other.mMin;
+  if(other.mMax > mMax)
+    mMax = other.mMax;
+}
+
+void LatencyHistogram::reset()
+{
+  for(unsigned i = 0; i < NUM_BUCKETS; i++)
+    mBuckets[i] = 0;
+
+  mCount = 0;
+  mSum = 0;
+  mMin = ~((uint64_t)0);
+  mMax = 0;
+}
+
+double LatencyHistogram::getMean() const
+{
+  if(mCount == 0)
+    return 0.0;
+
+  return (double)mSum / (double)mCount;
+}
+
+uint64_t LatencyHistogram::getPercentile(double percentile) const
+{
+  if(mCount == 0)
+    return 0;
+
+  uint64_t rank = (uint64_t)(percentile / 100.0 * (double)mCount + 0.5);
+  if(rank < 1)
+    rank = 1;
+  if(rank > mCount)
+    rank = mCount;
+
+  uint64_t seen = 0;
+  for(unsigned i = 0; i < NUM_BUCKETS; i++)
+  {
+    seen += mBuckets[i];
+    if(seen >= rank)
+    {
+      uint64_t bound = bucketUpperBound(i);
+      return bound > mMax ? mMax : bound;
+    }
+  }
+
+  return mMax;
+}
+
+void EvalStats::reset()
+{
+  invocations = 0;
+  fires = 0;
+  latency.reset();
+}
+
+void EngineStats::setEnabled(bool enabled)
+{
+  sEnabled = enabled;
+}
+
+uint64_t EngineStats::now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ((uint64_t)ts.tv_sec) * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+namespace
+{
+  /// one line of the report.
+  struct ReportEntry
+  {
+    std::string kind;   ///< "rule", "container" or "event".
+    std::string name;   ///< readable path of the item.
+    std::string type;   ///< container/event type.
+    const EvalStats *stats;
+  };
+
+  void collectContainer(std::vector<ReportEntry> &entries, EventContainer *container, const std::string &path)
+  {
+    ReportEntry entry;
+    entry.kind = "container";
+    entry.name = path;
+    entry.type = container->getTypeString();
+    entry.stats = &container->getStats();
+    entries.push_back(entry);
+
+    for(unsigned i = 0; i < container->mContainers.size(); i++)
+    {
+      std::ostringstream sub;
+      sub << path << "/c" << i;
+      collectContainer(entries, container->mContainers[i], sub.str());
+    }
+
+    const std::vector<Event *> &events = container->getEvents();
+    for(unsigned i = 0; i < events.size(); i++)
+    {
+      std::ostringstream sub;
+      sub << path << "/e" << i;
+
+      ReportEntry eventEntry;
+      eventEntry.kind = "event";
+      eventEntry.name = sub.str();
+      eventEntry.type = events[i]->getTypeString();
+      eventEntry.stats = &events[i]->getStats();
+      entries.push_back(eventEntry);
+    }
+  }
+
+  void collect(std::vector<ReportEntry> &entries, const std::vector<Rule *> &rules)
+  {
+    for(unsigned i = 0; i < rules.size(); i++)
+    {
+      Rule *rule = rules[i];
+      std::ostringstream path;
+      path << "rule" << rule->getID();
+
+      ReportEntry entry;
+      entry.kind = "rule";
+      entry.name = path.str();
+      entry.type = rule->getName();
+      entry.stats = &rule->getStats();
+      entries.push_back(entry);
+
+      if(rule->getEventContainer() != NULL)
+        collectContainer(entries, rule->getEventContainer(), path.str());
+    }
+  }
+
+  /// aggregate event statistics per event type.
+  void aggregateEventTypes(std::map<std::string, EvalStats> &perType, const std::vector<ReportEntry> &entries)
+  {
+    for(unsigned i = 0; i < entries.size(); i++)
+    {
+      if(entries[i].kind != "event")
+        continue;
+
+      EvalStats &total = perType[entries[i].type];
+      total.invocations += entries[i].stats->invocations;
+      total.fires += entries[i].stats->fires;
+      total.latency.merge(entries[i].stats->latency);
+    }
+  }
+
+  std::string jsonEscape(const std::string &value)
+  {
+    std::string out;
+    for(unsigned i = 0; i < value.size(); i++)
+    {
+      char c = value[i];
+      if(c == '"' || c == '\\')
+        out += '\\';
+      if((unsigned char)c < 0x20)
+        continue;
+      out += c;
+    }
+    return out;
+  }
+
+  void textLine(std::ostream &out, const std::string &kind, const std::string &name, const std::string &type, const EvalStats &s)
+  {
+    out << kind << " " << name << " [" << type << "]"
+        << " calls=" << s.invocations
+        << " fires=" << s.fires
+        << " mean_ns=" << (uint64_t)s.latency.getMean()
+        << " p50_ns=" << s.latency.getPercentile(50)
+        << " p99_ns=" << s.latency.getPercentile(99)
+        << " max_ns=" << s.latency.getMax()
+        << "\n";
+  }
+
+  void jsonObject(std::ostream &out, const std::string &kind, const std::string &name, const std::string &type, const EvalStats &s)
+  {
+    out << "{\"kind\":\"" << kind << "\""
+        << ",\"name\":\"" << jsonEscape(name) << "\""
+        << ",\"type\":\"" << jsonEscape(type) << "\""
+        << ",\"invocations\":" << s.invocations
+        << ",\"fires\":" << s.fires
+        << ",\"total_ns\":" << s.latency.getSum()
+        << ",\"mean_ns\":" << (uint64_t)s.latency.getMean()
+        << ",\"min_ns\":" << s.latency.getMin()
+        << ",\"p50_ns\":" << s.latency.getPercentile(50)
+        << ",\"p90_ns\":" << s.latency.getPercentile(90)
+        << ",\"p99_ns\":" << s.latency.getPercentile(99)
+        << ",\"max_ns\":" << s.latency.getMax()
+        << "}";
+  }
+}
+
+void EngineStats::dumpText(std::ostream &out, const std::vector<Rule *> &rules, const EvalStats &frame)
+{
+  std::vector<ReportEntry> entries;
+  collect(entries, rules);
+
+  std::map<std::string, EvalStats> perType;
+  aggregateEventTypes(perType, entries);
+
+  out << "=== rule engine statistics ===\n";
+  textLine(out, "frame", "processRule", "ALL", frame);
+
+  for(unsigned i = 0; i < entries.size(); i++)
+    textLine(out, entries[i].kind, entries[i].name, entries[i].type, *entries[i].stats);
+
+  std::map<std::string, EvalStats>::const_iterator it;
+  for(it = perType.begin(); it != perType.end(); ++it)
+    textLine(out, "event_type", it->first, it->first, it->second);
+
+  out.flush();
+}
+
+void EngineStats::dumpJson(std::ostream &out, const std::vector<Rule *> &rules, const EvalStats &frame)
+{
+  std::vector<ReportEntry> entries;
+  collect(entries, rules);
+
+  std::map<std::string, EvalStats> perType;
+  aggregateEventTypes(perType, entries);
+
+  out << "{\"frame\":";
+  jsonObject(out, "frame", "processRule", "ALL", frame);
+
+  out << ",\"items\":[";
+  for(unsigned i = 0; i < entries.size(); i++)
+  {
+    if(i > 0)
+      out << ",";
+    jsonObject(out, entries[i].kind, entries[i].name, entries[i].type, *entries[i].stats);
+  }
+
+  out << "],\"event_types\":[";
+  std::map<std::string, EvalStats>::const_iterator it;
+  for(it = perType.begin(); it != perType.end(); ++it)
+  {
+    if(it != perType.begin())
+      out << ",";
+    jsonObject(out, "event_type", it->first, it->first, it->second);
+  }
+  out << "]}\n";
+
+  out.flush();
+}
+
+namespace
+{
+  void resetContainer(EventContainer *container)
+  {
+    container->getStats().reset();
+
+    for(unsigned i = 0; i < container->mContainers.size(); i++)
+      resetContainer(container->mContainers[i]);
+
+    const std::vector<Event *> &events = container->getEvents();
+    for(unsigned i = 0; i < events.size(); i++)
+      events[i]->getStats().reset();
+  }
+}
+
+void EngineStats::reset(const std::vector<Rule *> &rules)
+{
+  for(unsigned i = 0; i < rules.size(); i++)
+  {
+    rules[i]->getStats().reset();
+    if(rules[i]->getEventContainer() != NULL)
+      resetContainer(rules[i]->getEventContainer());
+  }
+}
@@ -0,0 +1,179 @@
+/** \file
+  * Evaluation statistics of the rule engine: counters and latency histograms
+  * for rules, event containers and events.
+  *
+  * $Id$
+  */
+
+#ifndef ENGINESTATS_HPP
+#define ENGINESTATS_HPP
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdint.h>
+
+namespace Rbe
+{
+  class Rule;
+  class EventContainer;
+  class Event;
+
+  /**
+    * Log-linear latency histogram. Values are grouped by their power of two,
+    * each power of two is split in SUB_BUCKETS linear buckets, so the relative
+    * error of a percentile is at most 1/SUB_BUCKETS. Recording is a couple of
+    * integer operations and never allocates.
+    */
+  class LatencyHistogram
+  {
+  public:
+
+    enum
+    {
+      SUB_BUCKET_BITS = 3,                           ///< log2 of the linear buckets per power of two.
+      SUB_BUCKETS = 1 << SUB_BUCKET_BITS,            ///< linear buckets per power of two.
+      NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS ///< total number of buckets.
+    };
+
+    /// Constructor.
+    LatencyHistogram();
+
+    /**
+      * Add a sample.
+      *
+      * \param[in] value the sample, in nanoseconds.
+      */
+    void record(uint64_t value);
+
+    /// Merge the samples of another histogram into this one.
+    void merge(const LatencyHistogram &other);
+
+    /// Remove all samples.
+    void reset();
+
+    /// get the number of samples.
+    inline uint64_t getCount() const {return mCount;}
+
+    /// get the sum of all samples.
+    inline uint64_t getSum() const {return mSum;}
+
+    /// get the smallest sample, 0 if empty.
+    inline uint64_t getMin() const {return mCount == 0 ? 0 : mMin;}
+
+    /// get the largest sample.
+    inline uint64_t getMax() const {return mMax;}
+
+    /// get the mean of the samples, 0 if empty.
+    double getMean() const;
+
+    /**
+      * get an approximated percentile (upper bound of the bucket).
+      *
+      * \param[in] percentile value in the range [0,100].
+      */
+    uint64_t getPercentile(double percentile) const;
+
+  private:
+
+    static unsigned bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(unsigned index);
+
+    uint64_t mBuckets[NUM_BUCKETS]; ///< sample count per bucket.
+    uint64_t mCount;                ///< number of samples.
+    uint64_t mSum;                  ///< sum of the samples.
+    uint64_t mMin;                  ///< smallest sample.
+    uint64_t mMax;                  ///< largest sample.
+  };
+
+  /**
+    * Statistics of one evaluated item (rule, event container or event).
+    */
+  struct EvalStats
+  {
+    EvalStats() : invocations(0), fires(0) {}
+
+    /// Reset counters and histogram.
+    void reset();
+
+    uint64_t invocations;      ///< number of evaluations.
+    uint64_t fires;            ///< number of evaluations that resulted in true.
+    LatencyHistogram latency;  ///< evaluation time in nanoseconds.
+  };
+
+  /**
+    * Engine wide statistics switch, clock and report writer. The per-item
+    * statistics live inside Rule, EventContainer and Event so that the
+    * evaluation path never has to look anything up, the report walks the
+    * rule tree.
+    *
+    * When disabled (the default) the evaluation path only tests one flag.
+    */
+  class EngineStats
+  {
+  public:
+
+    /// Check if statistics are recorded.
+    static inline bool isEnabled() {return sEnabled;}
+
+    /**
+      * Switch recording of statistics on or off at runtime.
+      *
+      * \param[in] enabled true to record.
+      */
+    static void setEnabled(bool enabled);
+
+    /// Monotonic clock in nanoseconds.
+    static uint64_t now();
+
+    /**
+      * Write a human readable report.
+      *
+      * \param[out] out the stream to write to.
+      * \param[in] rules the rules to report.
+      * \param[in] frame statistics of the whole processRule() call per frame.
+      */
+    static void dumpText(std::ostream &out, const std::vector<Rule *> &rules, const EvalStats &frame);
+
+    /**
+      * Write a JSON report.
+      *
+      * \param[out] out the stream to write to.
+      * \param[in] rules the rules to report.
+      * \param[in] frame statistics of the whole processRule() call per frame.
+      */
+    static void dumpJson(std::ostream &out, const std::vector<Rule *> &rules, const EvalStats &frame);
+
+    /// Reset the statistics of every rule, container and event.
+    static void reset(const std::vector<Rule *> &rules);
+
+  private:
+    static bool sEnabled; ///< recording switch.
+  };
+
+  /**
+    * Scoped timer adding the elapsed time to an EvalStats when statistics are
+    * enabled. Does nothing (no clock read) when they are disabled.
+    */
+  class ScopedEvalTimer
+  {
+  public:
+    explicit ScopedEvalTimer(EvalStats &stats)
+      : mStats(stats), mStart(EngineStats::isEnabled() ? EngineStats::now() : 0) {}
+
+    ~ScopedEvalTimer()
+    {
+      if(mStart != 0)
+      {
+        mStats.invocations++;
+        mStats.latency.record(EngineStats::now() - mStart);
+      }
+    }
+
+  private:
+    EvalStats &mStats;
+    uint64_t mStart;
+  };
+}
+
+#endif // ENGINESTATS_HPP
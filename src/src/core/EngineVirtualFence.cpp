@@ -0,0 +1,92 @@
+#include "Engine.hpp"
+
+#include "Object.hpp"
+
+#include "vinotion/VirtualFencing/TrackedObjectVirtualFencing.hpp"
+
+using namespace Rbe;
+
+void Engine::loadObjectDataFromVirtualFence(std::vector<TrackedObjectVirtualFencing> &mTracksVF)
+{
+  if(mTracksVF.size() == 0)
+    mObjects.clear();
+  
+  if(mTracksVF.size() > 0)
+  {
+    if(mObjects.size() == 0)
+    {
+      for(int i = 0 ; i < mTracksVF.size();i++)
+      {
+        TrackedObjectVirtualFencing *trackV = &mTracksVF[i];
+        Object *newObject = new Object();
+        newObject->setId(trackV->mID);
+        trackV->setCurrentObjectFrame(newObject);
+        trackV->updateRbeObjectFrame(newObject);
+        trackV->updateRbeTrajectory(newObject);
+        
+        mObjects.push_back(newObject);
+      }
+    }
+    
+    else if(mObjects.size() > 0)
+    {
+      //update and add new
+      if(mObjects.size() <= mTracksVF.size())
+      {
+        for(int i = 0; i < mTracksVF.size(); i++)
+        {
+          TrackedObjectVirtualFencing *trackV = &mTracksVF[i];
+          
+          if(isObjectExist(trackV->mID))
+          {
+            //update                        
+            Object *newObject = mObjects[i];
+            trackV->setCurrentObjectFrame(newObject);
+            trackV->updateRbeObjectFrame(newObject);
+            trackV->updateRbeTrajectory(newObject);
+            
+          }
+          else
+          {
+            //add new 
+            Object *newObject = new Object();
+            newObject->setId(trackV->mID);
+            trackV->setCurrentObjectFrame(newObject);
+            trackV->updateRbeObjectFrame(newObject);
+            trackV->updateRbeTrajectory(newObject);
+            
+            mObjects.push_back(newObject);
+          }
+        }
+      }
+      
+      //remove
+      else if(mObjects.size() > mTracksVF.size())
+      {
+        for(int i = 0; i < mObjects.size(); i++)
+        {
+          Object *newObject = mObjects[i];
+          int objectID = newObject->getId();
+          
+          bool value = false;
+          for(int j = 0; j < mTracksVF.size(); j++)
+          {
+             TrackedObjectVirtualFencing *trackV = &mTracksVF[j];
+             int trackId = trackV->mID;
+             if(trackId == objectID)
+             {
+               value = true;               
+               break;
+             }             
+          }
+          
+          //remove if false
+          if(value == false)
+          {
+            mObjects.erase(mObjects.begin()+i);
+          }
+        }
+      }
+    }
+  }
+}
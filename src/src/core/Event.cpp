@@ -36,11 +36,16 @@ Event::Event(std::string type)
 
 std::string Event::getTypeString()
 {
-  if(mType == ENTER_AREA) return "ENTER_AREA";
-  if(mType == LEAVE_AREA) return "LEAVE_AREA";
-  if(mType == CROSSING_TRIPWIRE) return "CROSSING_TRIPWIRE";
-  if(mType == CROSSING_TRIPWIRE_LEFT2RIGHT) return "CROSSING_TRIPWIRE_LEFT2RIGHT";
-  if(mType == CROSSING_TRIPWIRE_RIGHT2LEFT) return "CROSSING_TRIPWIRE_RIGHT2LEFT";
+  return getTypeString(mType);
+}
+
+std::string Event::getTypeString(EventType type)
+{
+  if(type == ENTER_AREA) return "ENTER_AREA";
+  if(type == LEAVE_AREA) return "LEAVE_AREA";
+  if(type == CROSSING_TRIPWIRE) return "CROSSING_TRIPWIRE";
+  if(type == CROSSING_TRIPWIRE_LEFT2RIGHT) return "CROSSING_TRIPWIRE_LEFT2RIGHT";
+  if(type == CROSSING_TRIPWIRE_RIGHT2LEFT) return "CROSSING_TRIPWIRE_RIGHT2LEFT";
   return "";
 }
 
@@ -59,29 +64,35 @@ void Event::addFilter(EventFilter *filter)
   mFilters.push_back(filter);
 }
 
-void Event::process(std::vector<Context *> contexts, std::vector<Object *> objects)
+void Event::process(const FrameContext &frame)
 {
+  ScopedEvalTimer timer(mStats);
+  
   if(mType == Event::ENTER_AREA)
-    this->detectAreaEvent_Enter(contexts,objects);
+    this->detectAreaEvent_Enter(frame);
   
   if(mType == Event::LEAVE_AREA)
-    this->detectAreaEvent_Leave(contexts,objects);
+    this->detectAreaEvent_Leave(frame);
   
   if(mType == Event::CROSSING_TRIPWIRE)
-    this->detectTripwireEvent_Crossing(contexts,objects);
+    this->detectTripwireEvent_Crossing(frame);
   
   if(mType == Event::CROSSING_TRIPWIRE_LEFT2RIGHT)
-    this->detectTripwireEvent_Crossing(contexts,objects,1);
+    this->detectTripwireEvent_Crossing(frame,1);
   
   if(mType == Event::CROSSING_TRIPWIRE_RIGHT2LEFT)
-    this->detectTripwireEvent_Crossing(contexts,objects,2);
+    this->detectTripwireEvent_Crossing(frame,2);
 }
 
-bool Event::detectAreaEvent_Enter(std::vector<Context *> contexts, std::vector<Object *> objects)
+bool Event::detectAreaEvent_Enter(const FrameContext &frame)
 {
+  const std::vector<Context *> &contexts = frame.contexts;
+  const std::vector<Object *> &objects = frame.objects;
+  
   QueueStruct queueData;
   queueData.dataType = EVENT_QUEUE;
-  queueData.eventSource = this;      
+  queueData.eventSource = this;
+  queueData.time = frame.time;      
   
   std::vector<bool> resultFilters;
   
@@ -100,14 +111,15 @@ bool Event::detectAreaEvent_Enter(std::vector<Context *> contexts, std::vector<O
       }
       
       //this image should be global!!
-      QImage *image = area->getQImage();              
+      Raster *image = area->getMaskImage();              
       
       ObjectFrame *lastObjectFrame = object->getCurrentObjectFrame();
       
-      QRgb pixColor;
-      pixColor = image->pixel(lastObjectFrame->getXCenter(),lastObjectFrame->getYCenter());            
+      Rgb pixColor;
+      Point center = frame.toFrame(lastObjectFrame->getXCenter(),lastObjectFrame->getYCenter());
+      pixColor = image->pixel(center.x,center.y);            
       
-      QRgb objectColor = area->getRgbColorValue();
+      Rgb objectColor = area->getRgbColorValue();
       
       // Object enter area when it is moving (so the trajectory length should be more than a minimum length)               
       int minimumLenth = 3;
@@ -136,19 +148,25 @@ bool Event::detectAreaEvent_Enter(std::vector<Context *> contexts, std::vector<O
     }
   }  
   
+  recordFire(queueData.result);
+  
   if(this->mType == Event::ENTER_AREA)          
     mLinkToContainer->pushResultToQueue(queueData);  
   
   return queueData.result;
 }
 
-void Event::detectAreaEvent_Leave(std::vector<Context *> contexts, std::vector<Object *> objects)
-{ 
+void Event::detectAreaEvent_Leave(const FrameContext &frame)
+{
+  const std::vector<Context *> &contexts = frame.contexts;
+  const std::vector<Object *> &objects = frame.objects;
+  
   //detect enter_area event    
   bool value = false;  
   QueueStruct queueData;
   queueData.dataType = EVENT_QUEUE;
-  queueData.eventSource = this;      
+  queueData.eventSource = this;
+  queueData.time = frame.time;      
   std::vector<bool> resultFilters;
   static int area_id = -1;
   static int frameCount = 0;
@@ -169,14 +187,15 @@ void Event::detectAreaEvent_Leave(std::vector<Context *> contexts, std::vector<O
       }
       
       //this image should be global!!
-      QImage *image = area->getQImage();              
+      Raster *image = area->getMaskImage();              
       
       ObjectFrame *lastObjectFrame = object->getCurrentObjectFrame();
       
-      QRgb pixColor;
-      pixColor = image->pixel(lastObjectFrame->getXCenter(),lastObjectFrame->getYCenter());            
+      Rgb pixColor;
+      Point center = frame.toFrame(lastObjectFrame->getXCenter(),lastObjectFrame->getYCenter());
+      pixColor = image->pixel(center.x,center.y);            
       
-      QRgb objectColor = area->getRgbColorValue();
+      Rgb objectColor = area->getRgbColorValue();
       
       // Object enter area when it is moving (so the trajectory length should be more than a minimum length)               
       int minimumLenth = 3;
@@ -222,12 +241,16 @@ void Event::detectAreaEvent_Leave(std::vector<Context *> contexts, std::vector<O
     }
   }
   
+  recordFire(queueData.result);
   mLinkToContainer->pushResultToQueue(queueData);    
 }
 
 
-void Event::detectTripwireEvent_Crossing(std::vector<Context *> contexts, std::vector<Object *> objects, int direction)
+void Event::detectTripwireEvent_Crossing(const FrameContext &frame, int direction)
 {
+  const std::vector<Context *> &contexts = frame.contexts;
+  const std::vector<Object *> &objects = frame.objects;
+  
   //direction
   // 0: no direction
   // 1: left2right
@@ -236,7 +259,8 @@ void Event::detectTripwireEvent_Crossing(std::vector<Context *> contexts, std::v
   bool value = false;
   QueueStruct queueData;
   queueData.dataType = EVENT_QUEUE;
-  queueData.eventSource = this;    
+  queueData.eventSource = this;
+  queueData.time = frame.time;    
   
   std::vector<bool> resultFilters;
   
@@ -271,16 +295,16 @@ void Event::detectTripwireEvent_Crossing(std::vector<Context *> contexts, std::v
         float tripwireYIntersect = (float)(tripwirePoint1.y - tripwireSlope*tripwirePoint1.x);
         
         //get last point in the vector, not the first point
-        Point objectPoint1 = object->getTrajectory()[object->getTrajectory().size()-1];            
+        Point objectPoint1 = frame.toFrame(object->getTrajectory()[object->getTrajectory().size()-1]);            
         Point objectPoint2;
         
         int trajectoryLength = 5;
         if(object->getTrajectory().size() > trajectoryLength)
         {
-          objectPoint2 = object->getTrajectory()[object->getTrajectory().size()-trajectoryLength];
+          objectPoint2 = frame.toFrame(object->getTrajectory()[object->getTrajectory().size()-trajectoryLength]);
         }
         else
-          objectPoint2 = object->getTrajectory()[0];
+          objectPoint2 = frame.toFrame(object->getTrajectory()[0]);
         
         float objectSlope;
         if((objectPoint2.x - objectPoint1.x) == 0)
@@ -410,9 +434,16 @@ void Event::detectTripwireEvent_Crossing(std::vector<Context *> contexts, std::v
     }
   }
   
+  recordFire(queueData.result);
   mLinkToContainer->pushResultToQueue(queueData);         
 }
 
+void Event::recordFire(bool fired)
+{
+  if(fired && EngineStats::isEnabled())
+    mStats.fires++;
+}
+
 void Event::doAction()
 {
   for(int i = 0 ; i < mActions.size(); i++)
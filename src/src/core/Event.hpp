@@ -5,8 +5,8 @@
 #include <string>
 #include <iostream>
 #include <assert.h>
-#include <QRgb>
-#include <QColor>
+
+#include "EngineStats.hpp"
 
 namespace Rbe
 {
@@ -14,6 +14,7 @@ namespace Rbe
 class Action;
 class Context;
 class Object;
+struct FrameContext;
 class EventContainer;
 class EventFilter;
 
@@ -61,6 +62,8 @@ public:
   
   EventType getType(){return mType;}
   std::string getTypeString();
+  static std::string getTypeString(EventType type);
+  EvalStats &getStats(){return mStats;}
   void setLinkToContainer(EventContainer *link);      
   
   void addAction(Action *anAction);      
@@ -68,11 +71,11 @@ public:
   
   void doAction();
   
-  void process(std::vector<Context *> contexts, std::vector<Object *> objects);  
+  void process(const FrameContext &frame);  
   
-  bool detectAreaEvent_Enter(std::vector<Context *> contexts, std::vector<Object *> objects);  
-  void detectAreaEvent_Leave(std::vector<Context *> contexts, std::vector<Object *> objects);  
-  void detectTripwireEvent_Crossing(std::vector<Context *> contexts, std::vector<Object *> objects, int direction = 0);  
+  bool detectAreaEvent_Enter(const FrameContext &frame);  
+  void detectAreaEvent_Leave(const FrameContext &frame);  
+  void detectTripwireEvent_Crossing(const FrameContext &frame, int direction = 0);  
   
   // bool detectAreaEvent_Appear(std::vector<Context *> contexts, std::vector<Object*> objects);
   // bool detectAreaEvent_Disappear(std::vector<Context *> contexts, std::vector<Object*> objects);        
@@ -85,6 +88,9 @@ private:
   EventType mType;
   std::vector<Action* > mActions;
   std::vector<EventFilter* > mFilters;  
+  EvalStats mStats;
+  
+  void recordFire(bool fired);
 };
 
 }
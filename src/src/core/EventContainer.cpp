@@ -34,6 +34,15 @@ EventContainer::EventContainer(std::string type)
   order = 0;
 }
 
+std::string EventContainer::getTypeString()
+{
+  if(mType == AND) return "AND";
+  if(mType == OR) return "OR";
+  if(mType == SEQUENCE) return "SEQUENCE";
+  if(mType == ONE_EVENT) return "ONE_EVENT";
+  return "NO_CONTAINER_TYPE";
+}
+
 void EventContainer::addContainer(EventContainer *container)
 {
   mContainers.push_back(container);
@@ -63,11 +72,15 @@ void EventContainer::pushResultToQueue(QueueStruct &value)
   {    
     queueData.dataType = CONTAINER_QUEUE;
     queueData.eventSource = NULL; 
+    queueData.time = value.time;
     
   }
   
   if(processResultQueue() == true)
   {
+    if(EngineStats::isEnabled())
+      mStats.fires++;
+    
     if(linkToMama != NULL)
     { 
       queueData.result = true;
@@ -127,7 +140,7 @@ bool EventContainer::processResultQueue()
     {               
       if(mResultQueue[order].result == true)
       {
-        clocks.push_back(clock());
+        times.push_back(mResultQueue[order].time);
         
         if(order < mResultQueue.size())
           ++order;
@@ -135,13 +148,14 @@ bool EventContainer::processResultQueue()
           order = 0;
       }
       
-      if(clocks.size() == mContainers.size() + mEvents.size())
+      // the window is in input time, so it holds when frames are skipped or processed slower than real time
+      if(times.size() == mContainers.size() + mEvents.size())
       {
-        if( (clocks[clocks.size() - 1] - clocks[0]) <= (mSecond * CLOCKS_PER_SEC))
+        if( (times[times.size() - 1] - times[0]) <= mSecond)
         {
           value = true;         
         }
-        clocks.erase(clocks.begin(),clocks.end());
+        times.erase(times.begin(),times.end());
         order = 0;
       }
       
@@ -166,28 +180,29 @@ void EventContainer::cleanResultQueue()
   
 }
 
-void EventContainer::process(std::vector<Context *> contexts, std::vector<Object *> objects)
+void EventContainer::process(const FrameContext &frame)
 {
-  this->processSubContainers(contexts,objects);
-  this->processEvents(contexts,objects); 
+  ScopedEvalTimer timer(mStats);
+  
+  this->processSubContainers(frame);
+  this->processEvents(frame); 
 }
 
-void EventContainer::processSubContainers(std::vector<Context *> contexts, std::vector<Object *>objects)
+void EventContainer::processSubContainers(const FrameContext &frame)
 {
   for(int i = 0 ; i < mContainers.size(); i++)
   {       
     EventContainer *container = mContainers[i];
-    container->processSubContainers(contexts,objects);    
-    container->processEvents(contexts,objects); 
+    container->process(frame);
   }  
 }
 
-void EventContainer::processEvents(std::vector<Context *> contexts, std::vector<Object *> objects)
+void EventContainer::processEvents(const FrameContext &frame)
 { 
   for(int i = 0 ; i < mEvents.size(); i++)
   {       
     Event *event = mEvents[i];
-    event->process(contexts,objects);
+    event->process(frame);
   }  
 }
 
@@ -7,6 +7,8 @@
 #include <time.h>
 #include <stdio.h>
 
+#include "EngineStats.hpp"
+
 
 namespace Rbe
 {
@@ -15,6 +17,7 @@ class Event;
 class Action;
 class Context;
 class Object;
+struct FrameContext;
 
 class EventContainer
 {
@@ -27,14 +30,18 @@ public:
   ~EventContainer();
   
   ContainerType getType(){return mType;}
+  std::string getTypeString();
+  
+  const std::vector<Event *> &getEvents() const {return mEvents;}
+  EvalStats &getStats(){return mStats;}
   
   void addContainer(EventContainer *container);
   void addEvent(Event *event);
   void addAction(Action *anAction);      
   
-  void process(std::vector<Context *> contexts, std::vector<Object *>objects);      
-  void processSubContainers(std::vector<Context *> contexts, std::vector<Object *>objects);      
-  void processEvents(std::vector<Context *> contexts, std::vector<Object *>objects);        
+  void process(const FrameContext &frame);      
+  void processSubContainers(const FrameContext &frame);      
+  void processEvents(const FrameContext &frame);        
   
   std::vector<QueueStruct>mResultQueue;
   void pushResultToQueue(QueueStruct &qT);
@@ -49,11 +56,12 @@ public:
 private:
   
   int order;
-  std::vector<clock_t> clocks;
+  std::vector<double> times;  ///< frame times of the steps of a SEQUENCE so far.
   ContainerType mType;    
   
   std::vector<Event *> mEvents;
   std::vector<Action *> mActions;  
+  EvalStats mStats;
   void doAction();
 };
 
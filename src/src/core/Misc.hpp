@@ -8,7 +8,9 @@
 #define MISC_RBE_HPP
 
 #include <vector>
+#include <cstddef>
 #include <time.h>
+#include <stdint.h>
 
 namespace Rbe
 { 
@@ -21,6 +23,39 @@ namespace Rbe
     int y;  
   };
   
+  /**
+    * 0xAARRGGBB pixel value (same layout as QRgb).
+    */
+  typedef uint32_t Rgb;
+  
+  /**
+    * Color struct, 8 bit per channel.
+    */
+  struct Color
+  {
+    Color() : r(0), g(0), b(0), a(255) {}
+    Color(int red, int green, int blue, int alpha = 255) : r(red), g(green), b(blue), a(alpha) {}
+    
+    /// the color as 0xAARRGGBB.
+    inline Rgb rgba() const {return ((Rgb)a << 24) | ((Rgb)r << 16) | ((Rgb)g << 8) | (Rgb)b;}
+    
+    unsigned char r;
+    unsigned char g;
+    unsigned char b;
+    unsigned char a;
+  };
+  
+  /**
+    * Rectangle struct, empty when width or height is 0.
+    */
+  struct Rect
+  {
+    int x;
+    int y;
+    int width;
+    int height;
+  };
+  
   /**
     * Line struct. Each line has 2 points. 
     */
@@ -39,13 +74,78 @@ namespace Rbe
   
   class Event;
   class Object;
+  class Context;
+  
+  /**
+    * Maps the image the tracker ran on (a crop of the frame, possibly
+    * downscaled) to frame coordinates: frame = analysis * scale + offset.
+    */
+  struct AnalysisTransform
+  {
+    AnalysisTransform() : scale(1)
+    {
+      offset.x = 0;
+      offset.y = 0;
+    }
+    
+    /// an analysis pixel maps to the centre of its block of frame pixels.
+    inline Point toFrame(int x, int y) const
+    {
+      Point p;
+      p.x = x * scale + scale / 2 + offset.x;
+      p.y = y * scale + scale / 2 + offset.y;
+      return p;
+    }
+    inline Point toFrame(const Point &p) const {return toFrame(p.x, p.y);}
+    
+    /// the top left frame pixel of the block, for the edges of a box.
+    inline Point toFrameCorner(int x, int y) const
+    {
+      Point p;
+      p.x = x * scale + offset.x;
+      p.y = y * scale + offset.y;
+      return p;
+    }
+    
+    Point offset;  ///< position of the analysis image in the frame.
+    int scale;     ///< frame pixels per analysis pixel.
+  };
+  
+  /**
+    * Everything a rule is evaluated on in one frame. Passed by reference
+    * through Rule, EventContainer and Event, it refers to the engine vectors
+    * so nothing is copied while the rules are processed.
+    *
+    * Objects are in analysis coordinates (the image the tracker ran on),
+    * contexts in frame coordinates; toFrame() maps the one onto the other.
+    */
+  struct FrameContext
+  {
+    FrameContext(const std::vector<Context *> &frameContexts, const std::vector<Object *> &frameObjects)
+      : contexts(frameContexts), objects(frameObjects), time(0) {}
+    
+    FrameContext(const std::vector<Context *> &frameContexts, const std::vector<Object *> &frameObjects,
+                 const AnalysisTransform &frameAnalysis, double frameTime)
+      : contexts(frameContexts), objects(frameObjects), analysis(frameAnalysis), time(frameTime) {}
+    
+    /// an object position in frame coordinates.
+    inline Point toFrame(int x, int y) const {return analysis.toFrame(x, y);}
+    inline Point toFrame(const Point &p) const {return analysis.toFrame(p);}
+    
+    const std::vector<Context *> &contexts;
+    const std::vector<Object *> &objects;
+    AnalysisTransform analysis;
+    double time;  ///< time of the frame in the input, in seconds.
+  };
   
   struct QueueStruct
   {
+    QueueStruct() : result(false), dataType(0), contextID(-1), time(0), eventSource(NULL) {}
+    
     bool result;    
     int dataType;
     int contextID;
-    clock_t clock;
+    double time;  ///< time of the frame the result is from, in seconds.
     Event *eventSource;
     std::vector<int> objectsID;
   };
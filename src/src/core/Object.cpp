@@ -24,12 +24,12 @@ void Object::addTrajectory(Point &p)
   mTrajectory.push_back(p);
 }
 
-std::vector<ObjectFrame* > Object::getObjectFrames()
+const std::vector<ObjectFrame* > &Object::getObjectFrames() const
 {
   return mObjectFrames;
 }
 
-std::vector<Point> Object::getTrajectory()
+const std::vector<Point> &Object::getTrajectory() const
 {
   return mTrajectory;
 }
@@ -110,6 +110,12 @@ void Object::clearTrajectory()
   mTrajectory.clear();
 }
 
+void Object::trimTrajectory(unsigned maxLength)
+{
+  if(mTrajectory.size() > maxLength)
+    mTrajectory.erase(mTrajectory.begin(), mTrajectory.end() - maxLength);
+}
+
 Object::~Object()
 {
   delete mCurrentObjectFrame;
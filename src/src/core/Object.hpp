@@ -30,10 +30,10 @@ namespace Rbe
     ObjectFrame *getCurrentObjectFrame();
     void setCurrentObjectFrame(ObjectFrame* f);
     void addObjectFrame(ObjectFrame *f);   
-    std::vector<ObjectFrame* > getObjectFrames();
+    const std::vector<ObjectFrame* > &getObjectFrames() const;
     
     void addTrajectory(Point &p);    
-    std::vector<Point> getTrajectory();
+    const std::vector<Point> &getTrajectory() const;
        
     void addEventQueue(EventQueue &queue);
     EventQueue mAnEventQueue;
@@ -41,6 +41,8 @@ namespace Rbe
     
     void clearObjectFrames();
     void clearTrajectory();
+    /// keep only the newest maxLength points of the trajectory.
+    void trimTrajectory(unsigned maxLength);
     void clearEventQueue();
     
     std::string eventTypeToString(int type);
@@ -0,0 +1,165 @@
+#include "PolygonRasterizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include <png.h>
+
+using namespace Rbe;
+
+namespace
+{
+  /// a PNG file written row by row.
+  class PngWriter
+  {
+  public:
+    PngWriter() : mFile(NULL), mPng(NULL), mInfo(NULL) {}
+    ~PngWriter() {close();}
+
+    bool open(const std::string &filePath, unsigned width, unsigned height, int bitDepth, int colorType)
+    {
+      mFile = fopen(filePath.c_str(), "wb");
+      if(mFile == NULL)
+        return false;
+
+      mPng = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+      mInfo = mPng != NULL ? png_create_info_struct(mPng) : NULL;
+      if(mInfo == NULL || setjmp(png_jmpbuf(mPng)))
+        return false;
+
+      png_init_io(mPng, mFile);
+      png_set_IHDR(mPng, mInfo, width, height, bitDepth, colorType,
+                   PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+      png_write_info(mPng, mInfo);
+      return true;
+    }
+
+    bool writeRow(png_byte *row)
+    {
+      if(setjmp(png_jmpbuf(mPng)))
+        return false;
+      png_write_row(mPng, row);
+      return true;
+    }
+
+    bool finish()
+    {
+      if(setjmp(png_jmpbuf(mPng)))
+        return false;
+      png_write_end(mPng, NULL);
+      return true;
+    }
+
+    void close()
+    {
+      if(mPng != NULL)
+        png_destroy_write_struct(&mPng, mInfo != NULL ? &mInfo : NULL);
+      if(mFile != NULL)
+        fclose(mFile);
+      mPng = NULL;
+      mInfo = NULL;
+      mFile = NULL;
+    }
+
+  private:
+    FILE *mFile;
+    png_structp mPng;
+    png_infop mInfo;
+  };
+}
+
+PolygonRasterizer::PolygonRasterizer(unsigned width, unsigned height)
+  : mWidth(width), mHeight(height), mLabels(width * height, 0)
+{
+}
+
+void PolygonRasterizer::clear()
+{
+  std::fill(mLabels.begin(), mLabels.end(), 0);
+}
+
+void PolygonRasterizer::fill(const std::vector<Point> &polygon, uint16_t label)
+{
+  if(polygon.size() < 3 || mWidth == 0 || mHeight == 0)
+    return;
+
+  int yMin = polygon[0].y, yMax = polygon[0].y;
+  for(unsigned i = 1; i < polygon.size(); i++)
+  {
+    yMin = std::min(yMin, polygon[i].y);
+    yMax = std::max(yMax, polygon[i].y);
+  }
+  yMin = std::max(yMin, 0);
+  yMax = std::min(yMax, (int)mHeight - 1);
+
+  for(int y = yMin; y <= yMax; y++)
+  {
+    // crossings of the edges with the line through the pixel centres
+    float yc = y + 0.5f;
+    mCrossings.clear();
+    for(unsigned i = 0; i < polygon.size(); i++)
+    {
+      const Point &a = polygon[i];
+      const Point &b = polygon[(i + 1) % polygon.size()];
+      if((a.y <= yc) == (b.y <= yc))
+        continue;
+      mCrossings.push_back(a.x + (yc - a.y) * (b.x - a.x) / (float)(b.y - a.y));
+    }
+    std::sort(mCrossings.begin(), mCrossings.end());
+
+    // even-odd: the pixels whose centre lies between a pair of crossings
+    uint16_t *row = &mLabels[y * mWidth];
+    for(unsigned i = 0; i + 1 < mCrossings.size(); i += 2)
+    {
+      int x0 = std::max(0, (int)ceilf(mCrossings[i] - 0.5f));
+      int x1 = std::min((int)mWidth, (int)ceilf(mCrossings[i + 1] - 0.5f));
+      if(x0 < x1)
+        std::fill(row + x0, row + x1, label);
+    }
+  }
+}
+
+bool PolygonRasterizer::savePng(const std::string &labelPath, const std::string &colorPath, const std::vector<Rgb> &palette) const
+{
+  if(mWidth == 0 || mHeight == 0 || palette.empty())
+    return false;
+
+  PngWriter labelPng;
+  PngWriter colorPng;
+  bool labels = !labelPath.empty();
+  if(labels && !labelPng.open(labelPath, mWidth, mHeight, 16, PNG_COLOR_TYPE_GRAY))
+    return false;
+  if(!colorPng.open(colorPath, mWidth, mHeight, 8, PNG_COLOR_TYPE_RGB_ALPHA))
+    return false;
+
+  // full 65536 entry palette, no bounds test per pixel
+  std::vector<Rgb> colors(65536, palette[0]);
+  std::copy(palette.begin(), palette.begin() + std::min<size_t>(palette.size(), colors.size()), colors.begin());
+
+  std::vector<png_byte> row(mWidth * 4);
+  std::vector<png_byte> labelRow(mWidth * 2);
+  for(unsigned y = 0; y < mHeight; y++)
+  {
+    const uint16_t *src = &mLabels[y * mWidth];
+    for(unsigned x = 0; x < mWidth; x++)
+    {
+      Rgb c = colors[src[x]];
+      row[x * 4 + 0] = (c >> 16) & 0xff;
+      row[x * 4 + 1] = (c >> 8) & 0xff;
+      row[x * 4 + 2] = c & 0xff;
+      row[x * 4 + 3] = c >> 24;
+
+      // PNG samples are big endian
+      labelRow[x * 2 + 0] = src[x] >> 8;
+      labelRow[x * 2 + 1] = src[x] & 0xff;
+    }
+
+    if(labels && !labelPng.writeRow(&labelRow[0]))
+      return false;
+    if(!colorPng.writeRow(&row[0]))
+      return false;
+  }
+
+  return (!labels || labelPng.finish()) && colorPng.finish();
+}
@@ -0,0 +1,72 @@
+/** \file
+  * The PolygonRasterizer class file. Scanline fill of the area polygons into
+  * a label raster, from which the context masks are written.
+  *
+  * $Id$
+  */
+
+#ifndef POLYGONRASTERIZER_HPP
+#define POLYGONRASTERIZER_HPP
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "Misc.hpp"
+
+namespace Rbe
+{
+  /**
+    * A width x height raster of 16 bit labels, 0 is the background. Polygons
+    * are filled with the even-odd rule, a pixel is inside when its centre
+    * is (as a non antialiased QPainter fill); a later polygon overwrites an
+    * earlier one where they overlap.
+    */
+  class PolygonRasterizer
+  {
+  public:
+    /**
+      * Constructor, all pixels are background.
+      *
+      * \param[in] width width in pixels.
+      * \param[in] height height in pixels.
+      */
+    PolygonRasterizer(unsigned width, unsigned height);
+
+    /// set all pixels to the background.
+    void clear();
+
+    /**
+      * Fill a polygon.
+      *
+      * \param[in] polygon the vertices, the polygon is closed implicitly.
+      * \param[in] label the label of the pixels inside, 1 to 65535.
+      */
+    void fill(const std::vector<Point> &polygon, uint16_t label);
+
+    inline unsigned getWidth() const {return mWidth;}
+    inline unsigned getHeight() const {return mHeight;}
+    inline uint16_t getLabel(unsigned x, unsigned y) const {return mLabels[y * mWidth + x];}
+    inline const std::vector<uint16_t> &getLabels() const {return mLabels;}
+
+    /**
+      * Write the labels as 16 bit gray PNG and as colour PNG, in one pass
+      * over the pixels.
+      *
+      * \param[in] labelPath path of the label PNG, not written when empty.
+      * \param[in] colorPath path of the colour PNG.
+      * \param[in] palette colour of every label, palette[0] is the background.
+      *                    Labels past the end of the palette get palette[0].
+      * \return false if a file could not be written.
+      */
+    bool savePng(const std::string &labelPath, const std::string &colorPath, const std::vector<Rgb> &palette) const;
+
+  private:
+    unsigned mWidth;
+    unsigned mHeight;
+    std::vector<uint16_t> mLabels;
+    std::vector<float> mCrossings;  ///< reused by fill().
+  };
+}
+
+#endif // POLYGONRASTERIZER_HPP
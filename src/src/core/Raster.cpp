@@ -0,0 +1,150 @@
+#include "Raster.hpp"
+
+#include <stdio.h>
+#include <png.h>
+
+using namespace Rbe;
+
+Raster::Raster()
+{
+  mWidth = 0;
+  mHeight = 0;
+}
+
+Raster::Raster(unsigned width, unsigned height, Rgb fill)
+{
+  resize(width, height, fill);
+}
+
+void Raster::resize(unsigned width, unsigned height, Rgb fill)
+{
+  mWidth = width;
+  mHeight = height;
+  mPixels.assign(width * height, fill);
+}
+
+bool Raster::loadPng(const std::string &filePath)
+{
+  resize(0, 0);
+
+  FILE *file = fopen(filePath.c_str(), "rb");
+  if(file == NULL)
+    return false;
+
+  png_byte signature[8];
+  if(fread(signature, 1, 8, file) != 8 || png_sig_cmp(signature, 0, 8) != 0)
+  {
+    fclose(file);
+    return false;
+  }
+
+  png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+  png_infop info = png != NULL ? png_create_info_struct(png) : NULL;
+  if(info == NULL)
+  {
+    png_destroy_read_struct(&png, NULL, NULL);
+    fclose(file);
+    return false;
+  }
+
+  std::vector<png_byte> rgba;
+  if(setjmp(png_jmpbuf(png)))
+  {
+    png_destroy_read_struct(&png, &info, NULL);
+    fclose(file);
+    resize(0, 0);
+    return false;
+  }
+
+  png_init_io(png, file);
+  png_set_sig_bytes(png, 8);
+  png_read_info(png, info);
+
+  // convert everything to 8 bit RGBA
+  png_byte colorType = png_get_color_type(png, info);
+  if(png_get_bit_depth(png, info) == 16)
+    png_set_strip_16(png);
+  if(colorType == PNG_COLOR_TYPE_PALETTE)
+    png_set_palette_to_rgb(png);
+  if(colorType == PNG_COLOR_TYPE_GRAY && png_get_bit_depth(png, info) < 8)
+    png_set_expand_gray_1_2_4_to_8(png);
+  if(png_get_valid(png, info, PNG_INFO_tRNS))
+    png_set_tRNS_to_alpha(png);
+  if(colorType == PNG_COLOR_TYPE_GRAY || colorType == PNG_COLOR_TYPE_GRAY_ALPHA)
+    png_set_gray_to_rgb(png);
+  png_set_filler(png, 0xff, PNG_FILLER_AFTER);
+  png_read_update_info(png, info);
+
+  unsigned width = png_get_image_width(png, info);
+  unsigned height = png_get_image_height(png, info);
+
+  rgba.resize(width * height * 4);
+  std::vector<png_bytep> rows(height);
+  for(unsigned y = 0; y < height; y++)
+    rows[y] = &rgba[y * width * 4];
+
+  png_read_image(png, &rows[0]);
+  png_read_end(png, NULL);
+  png_destroy_read_struct(&png, &info, NULL);
+  fclose(file);
+
+  resize(width, height);
+  for(unsigned i = 0; i < width * height; i++)
+  {
+    const png_byte *p = &rgba[i * 4];
+    mPixels[i] = ((Rgb)p[3] << 24) | ((Rgb)p[0] << 16) | ((Rgb)p[1] << 8) | (Rgb)p[2];
+  }
+
+  return true;
+}
+
+bool Raster::savePng(const std::string &filePath) const
+{
+  if(isNull())
+    return false;
+
+  FILE *file = fopen(filePath.c_str(), "wb");
+  if(file == NULL)
+    return false;
+
+  png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+  png_infop info = png != NULL ? png_create_info_struct(png) : NULL;
+  if(info == NULL)
+  {
+    png_destroy_write_struct(&png, NULL);
+    fclose(file);
+    return false;
+  }
+
+  std::vector<png_byte> row(mWidth * 4);
+  if(setjmp(png_jmpbuf(png)))
+  {
+    png_destroy_write_struct(&png, &info);
+    fclose(file);
+    return false;
+  }
+
+  png_init_io(png, file);
+  png_set_IHDR(png, info, mWidth, mHeight, 8, PNG_COLOR_TYPE_RGB_ALPHA,
+               PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+  png_write_info(png, info);
+
+  for(unsigned y = 0; y < mHeight; y++)
+  {
+    const Rgb *pixels = scanLine(y);
+    for(unsigned x = 0; x < mWidth; x++)
+    {
+      row[x * 4 + 0] = (pixels[x] >> 16) & 0xff;
+      row[x * 4 + 1] = (pixels[x] >> 8) & 0xff;
+      row[x * 4 + 2] = pixels[x] & 0xff;
+      row[x * 4 + 3] = pixels[x] >> 24;
+    }
+    png_write_row(png, &row[0]);
+  }
+
+  png_write_end(png, NULL);
+  png_destroy_write_struct(&png, &info);
+  fclose(file);
+
+  return true;
+}
@@ -0,0 +1,87 @@
+/** \file
+  * The Raster class file. A minimal 32 bit ARGB image for the context masks,
+  * so the core does not depend on Qt.
+  *
+  * $Id$
+  */
+
+#ifndef RASTER_HPP
+#define RASTER_HPP
+
+#include <string>
+#include <vector>
+
+#include "Misc.hpp"
+
+namespace Rbe
+{
+  /**
+    * Raster class, a width x height array of 0xAARRGGBB pixels (same layout
+    * as a QRgb, so colours compare the same as with a QImage mask).
+    */
+  class Raster
+  {
+  public:
+
+    /// Constructor, empty raster.
+    Raster();
+
+    /**
+      * Constructor.
+      *
+      * \param[in] width width in pixels.
+      * \param[in] height height in pixels.
+      * \param[in] fill initial value of every pixel.
+      */
+    Raster(unsigned width, unsigned height, Rgb fill = 0);
+
+    /**
+      * Load a PNG file, any PNG colour type is converted to 8 bit ARGB.
+      *
+      * \param[in] filePath the path of the PNG file.
+      * \return false if the file could not be read, the raster is then empty.
+      */
+    bool loadPng(const std::string &filePath);
+
+    /**
+      * Save as 8 bit RGBA PNG file.
+      *
+      * \param[in] filePath the path of the PNG file.
+      * \return false if the file could not be written.
+      */
+    bool savePng(const std::string &filePath) const;
+
+    /// Resize, the content is set to fill.
+    void resize(unsigned width, unsigned height, Rgb fill = 0);
+
+    inline unsigned getWidth() const {return mWidth;}
+    inline unsigned getHeight() const {return mHeight;}
+    inline bool isNull() const {return mPixels.empty();}
+
+    /**
+      * get a pixel.
+      *
+      * \return the pixel, 0 when (x,y) is outside the raster (as QImage::pixel).
+      */
+    inline Rgb pixel(int x, int y) const
+    {
+      if(x < 0 || y < 0 || (unsigned)x >= mWidth || (unsigned)y >= mHeight)
+        return 0;
+      return mPixels[(unsigned)y * mWidth + (unsigned)x];
+    }
+
+    /// set a pixel, (x,y) must be inside the raster.
+    inline void setPixel(int x, int y, Rgb value) {mPixels[(unsigned)y * mWidth + (unsigned)x] = value;}
+
+    /// pointer to the first pixel of row y.
+    inline Rgb *scanLine(unsigned y) {return &mPixels[y * mWidth];}
+    inline const Rgb *scanLine(unsigned y) const {return &mPixels[y * mWidth];}
+
+  private:
+    unsigned mWidth;
+    unsigned mHeight;
+    std::vector<Rgb> mPixels;  ///< row major pixels.
+  };
+}
+
+#endif // RASTER_HPP
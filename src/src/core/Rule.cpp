@@ -31,9 +31,15 @@ EventContainer* Rule::getEventContainer()
   return mEventContainer;
 } 
 
-void Rule::process(std::vector<Context *> contexts, std::vector<Object*> objects)
+void Rule::process(const FrameContext &frame)
 {   
-  mEventContainer->process(contexts,objects);  
+  ScopedEvalTimer timer(mStats);
+  uint64_t firesBefore = mEventContainer->getStats().fires;
+  
+  mEventContainer->process(frame);  
+  
+  if(mEventContainer->getStats().fires != firesBefore)
+    mStats.fires++;
 }
 
 void Rule::cleanEventResultQueue()
@@ -9,11 +9,14 @@
 #include <libxml/xpathInternals.h>
 #include <libxml/tree.h>
 
+#include "EngineStats.hpp"
+
 namespace Rbe
 {   
   class EventContainer;
   class Context;
   class Object;
+  struct FrameContext;
   class Rule
   {    
   public:
@@ -33,14 +36,17 @@ namespace Rbe
     void setEventContainer(EventContainer *eC);
     EventContainer*  getEventContainer();
         
-    void process(std::vector<Context *> contexts, std::vector<Object*> objects);    
+    void process(const FrameContext &frame);    
     void cleanEventResultQueue();
+    
+    EvalStats &getStats(){return mStats;}
 
   private:
     int mId;
     std::string mName;
     std::string mDesc;           
     EventContainer *mEventContainer;
+    EvalStats mStats;
   };
 }
 
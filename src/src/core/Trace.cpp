@@ -0,0 +1,182 @@
+#include "Trace.hpp"
+
+#include <time.h>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+using namespace Rbe;
+
+bool Trace::sEnabled = false;
+unsigned Trace::sCapacity = 65536;
+
+namespace
+{
+  /// one recorded stage.
+  struct TraceEvent
+  {
+    const char *name;
+    uint64_t start;
+    uint64_t end;
+    int64_t frame;
+  };
+
+  /// the events of one thread.
+  struct ThreadRing
+  {
+    ThreadRing(unsigned capacity, unsigned id)
+      : events(capacity), next(0), count(0), tid(id) {}
+
+    std::vector<TraceEvent> events;
+    unsigned next;        ///< slot the next event is written to.
+    unsigned count;       ///< number of valid events.
+    unsigned tid;         ///< thread id in the trace.
+    std::string name;     ///< thread name in the trace.
+    boost::mutex mutex;   ///< only contended while flushing.
+  };
+
+  boost::mutex gRingsMutex;
+  std::vector<ThreadRing *> gRings;   ///< all rings, owned until Trace::endThread().
+  unsigned gNextTid = 1;              ///< never reused, a new thread gets its own track.
+
+  /// the rings are kept alive after their thread ended, so no cleanup.
+  void noCleanup(ThreadRing *) {}
+
+  boost::thread_specific_ptr<ThreadRing> gThreadRing(noCleanup);
+
+  ThreadRing *threadRing(unsigned capacity)
+  {
+    ThreadRing *ring = gThreadRing.get();
+    if(ring == NULL)
+    {
+      boost::mutex::scoped_lock lock(gRingsMutex);
+      ring = new ThreadRing(capacity, gNextTid++);
+      gRings.push_back(ring);
+      gThreadRing.reset(ring);
+    }
+    return ring;
+  }
+
+  std::string jsonEscape(const std::string &value)
+  {
+    std::string out;
+    for(unsigned i = 0; i < value.size(); i++)
+    {
+      char c = value[i];
+      if(c == '"' || c == '\\')
+        out += '\\';
+      if((unsigned char)c < 0x20)
+        continue;
+      out += c;
+    }
+    return out;
+  }
+}
+
+void Trace::setEnabled(bool enabled, unsigned capacity)
+{
+  if(capacity > 0)
+    sCapacity = capacity;
+  sEnabled = enabled;
+}
+
+void Trace::setThreadName(const std::string &name)
+{
+  ThreadRing *ring = threadRing(sCapacity);
+  boost::mutex::scoped_lock lock(ring->mutex);
+  ring->name = name;
+}
+
+uint64_t Trace::now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ((uint64_t)ts.tv_sec) * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void Trace::record(const char *name, uint64_t start, uint64_t end, int64_t frame)
+{
+  ThreadRing *ring = threadRing(sCapacity);
+  boost::mutex::scoped_lock lock(ring->mutex);
+
+  TraceEvent &event = ring->events[ring->next];
+  event.name = name;
+  event.start = start;
+  event.end = end;
+  event.frame = frame;
+
+  ring->next = (ring->next + 1) % ring->events.size();
+  if(ring->count < ring->events.size())
+    ring->count++;
+}
+
+bool Trace::flush(const std::string &fileName)
+{
+  std::ofstream out(fileName.c_str());
+  if(!out.is_open())
+    return false;
+
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  out.setf(std::ios::fixed);
+  out.precision(3);
+
+  bool first = true;
+  boost::mutex::scoped_lock listLock(gRingsMutex);
+  for(unsigned r = 0; r < gRings.size(); r++)
+  {
+    ThreadRing *ring = gRings[r];
+    boost::mutex::scoped_lock lock(ring->mutex);
+
+    if(!ring->name.empty())
+    {
+      out << (first ? "" : ",\n")
+          << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->tid
+          << ",\"args\":{\"name\":\"" << jsonEscape(ring->name) << "\"}}";
+      first = false;
+    }
+
+    // oldest event first
+    unsigned size = ring->events.size();
+    unsigned begin = (ring->next + size - ring->count) % size;
+    for(unsigned i = 0; i < ring->count; i++)
+    {
+      const TraceEvent &event = ring->events[(begin + i) % size];
+      out << (first ? "" : ",\n")
+          << "{\"name\":\"" << event.name << "\",\"cat\":\"rbe\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->tid
+          << ",\"ts\":" << event.start / 1000.0
+          << ",\"dur\":" << (event.end - event.start) / 1000.0
+          << ",\"args\":{\"frame\":" << event.frame << "}}";
+      first = false;
+    }
+  }
+
+  out << "\n]}\n";
+  return out.good();
+}
+
+void Trace::endThread()
+{
+  ThreadRing *ring = gThreadRing.get();
+  if(ring == NULL)
+    return;
+  gThreadRing.reset();
+
+  boost::mutex::scoped_lock listLock(gRingsMutex);
+  gRings.erase(std::remove(gRings.begin(), gRings.end(), ring), gRings.end());
+  delete ring;
+}
+
+void Trace::clear()
+{
+  boost::mutex::scoped_lock listLock(gRingsMutex);
+  for(unsigned r = 0; r < gRings.size(); r++)
+  {
+    boost::mutex::scoped_lock lock(gRings[r]->mutex);
+    gRings[r]->next = 0;
+    gRings[r]->count = 0;
+  }
+}
@@ -0,0 +1,113 @@
+/** \file
+  * Lightweight stage tracing, written as Chrome/Perfetto trace-event JSON.
+  *
+  * $Id$
+  */
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <string>
+#include <stdint.h>
+
+namespace Rbe
+{
+  /**
+    * Records begin time and duration of named stages per thread into a fixed
+    * size in-memory ring (the oldest events are overwritten). The rings are
+    * written on request as a trace-event JSON file that can be opened in
+    * chrome://tracing or ui.perfetto.dev.
+    *
+    * Every thread gets its own ring, so recording never contends with other
+    * threads. When tracing is disabled (the default) a stage costs a single
+    * flag test.
+    */
+  class Trace
+  {
+  public:
+
+    /// Check if tracing is on.
+    static inline bool isEnabled() {return sEnabled;}
+
+    /**
+      * Switch tracing on or off.
+      *
+      * \param[in] enabled true to record.
+      * \param[in] capacity number of events kept per thread.
+      */
+    static void setEnabled(bool enabled, unsigned capacity = 65536);
+
+    /**
+      * Name the calling thread in the trace.
+      *
+      * \param[in] name the thread name.
+      */
+    static void setThreadName(const std::string &name);
+
+    /**
+      * Record one completed stage of the calling thread.
+      *
+      * \param[in] name stage name, must be a string literal (only the pointer is stored).
+      * \param[in] start begin time in nanoseconds (see now()).
+      * \param[in] end end time in nanoseconds.
+      * \param[in] frame frame number the stage belongs to.
+      */
+    static void record(const char *name, uint64_t start, uint64_t end, int64_t frame);
+
+    /// Monotonic clock in nanoseconds.
+    static uint64_t now();
+
+    /**
+      * Write all recorded events to a trace-event JSON file. The rings are
+      * not cleared, so the file can be written several times during a run.
+      *
+      * \param[in] fileName the file to write.
+      * \return true on success.
+      */
+    static bool flush(const std::string &fileName);
+
+    /// Remove all recorded events.
+    static void clear();
+
+    /**
+      * Free the ring of the calling thread, its events are dropped. Called
+      * by a thread that recorded before it ends, otherwise the ring is kept
+      * for the process lifetime.
+      */
+    static void endThread();
+
+  private:
+    static bool sEnabled;       ///< recording switch.
+    static unsigned sCapacity;  ///< events per thread ring.
+  };
+
+  /**
+    * Records the lifetime of the scope, or until end() is called, as one stage.
+    */
+  class ScopedTrace
+  {
+  public:
+    ScopedTrace(const char *name, int64_t frame)
+      : mName(name), mFrame(frame), mStart(Trace::isEnabled() ? Trace::now() : 0) {}
+
+    ~ScopedTrace() {end();}
+
+    /// End the stage before the scope ends.
+    void end()
+    {
+      if(mStart != 0)
+        Trace::record(mName, mStart, Trace::now(), mFrame);
+      mStart = 0;
+    }
+
+    /// Drop the stage, nothing is recorded.
+    void cancel() {mStart = 0;}
+
+  private:
+    const char *mName;
+    int64_t mFrame;
+    uint64_t mStart;
+  };
+}
+
+#endif // TRACE_HPP
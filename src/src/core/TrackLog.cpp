@@ -0,0 +1,401 @@
+#include "TrackLog.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+#include "Object.hpp"
+#include "ObjectFrame.hpp"
+#include "AlertIndex.hpp"
+#include "Rule.hpp"
+#include "Event.hpp"
+#include "Misc.hpp"
+
+using namespace Rbe;
+
+namespace
+{
+  const char LOG_MAGIC[4] = {'R', 'B', 'T', 'L'};
+  const char INDEX_MAGIC[4] = {'R', 'B', 'T', 'I'};
+  const uint32_t LOG_VERSION = 2;        ///< 2 added the alerts.
+  const uint32_t INDEX_VERSION = 1;
+
+  const unsigned HEADER_SIZE = 8;           ///< magic and version.
+  const unsigned FRAME_HEADER_SIZE_V1 = 8;  ///< frame number and record count.
+  const unsigned FRAME_HEADER_SIZE = 12;    ///< frame number, record count and alert count.
+  const unsigned RECORD_SIZE = 16;
+  const unsigned ALERT_SIZE = 12;
+  const unsigned INDEX_ENTRY_SIZE = 12;     ///< frame number and offset.
+
+  void putU32(std::vector<char> &buffer, uint32_t value)
+  {
+    for(unsigned i = 0; i < 4; i++)
+      buffer.push_back((char)((value >> (8 * i)) & 0xff));
+  }
+
+  void putU64(std::vector<char> &buffer, uint64_t value)
+  {
+    for(unsigned i = 0; i < 8; i++)
+      buffer.push_back((char)((value >> (8 * i)) & 0xff));
+  }
+
+  void putI16(std::vector<char> &buffer, int16_t value)
+  {
+    uint16_t u = (uint16_t)value;
+    buffer.push_back((char)(u & 0xff));
+    buffer.push_back((char)(u >> 8));
+  }
+
+  uint32_t getU32(const unsigned char *p)
+  {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+  }
+
+  uint64_t getU64(const unsigned char *p)
+  {
+    return (uint64_t)getU32(p) | ((uint64_t)getU32(p + 4) << 32);
+  }
+
+  int16_t getI16(const unsigned char *p)
+  {
+    return (int16_t)(uint16_t)(p[0] | (p[1] << 8));
+  }
+
+  int16_t clamp16(int value)
+  {
+    if(value > 32767) return 32767;
+    if(value < -32768) return -32768;
+    return (int16_t)value;
+  }
+
+  void header(std::vector<char> &buffer, const char magic[4], uint32_t version)
+  {
+    buffer.insert(buffer.end(), magic, magic + 4);
+    putU32(buffer, version);
+  }
+
+  /// the version of the file, 0 if it is not a file with this magic.
+  uint32_t checkHeader(std::ifstream &in, const char magic[4])
+  {
+    unsigned char buffer[HEADER_SIZE];
+    in.read((char *)buffer, HEADER_SIZE);
+    if(in.gcount() != HEADER_SIZE || memcmp(buffer, magic, 4) != 0)
+      return 0;
+    return getU32(buffer + 4);
+  }
+}
+
+// ======================
+// === TrackLogWriter ===
+// ======================
+
+TrackLogWriter::TrackLogWriter()
+{
+  mOffset = 0;
+}
+
+TrackLogWriter::~TrackLogWriter()
+{
+  close();
+}
+
+bool TrackLogWriter::open(const std::string &fileName)
+{
+  close();
+
+  mLog.open(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  mIndex.open((fileName + ".idx").c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if(!mLog.is_open() || !mIndex.is_open())
+  {
+    close();
+    return false;
+  }
+
+  std::vector<char> buffer;
+  header(buffer, LOG_MAGIC, LOG_VERSION);
+  mLog.write(&buffer[0], buffer.size());
+  mOffset = buffer.size();
+
+  buffer.clear();
+  header(buffer, INDEX_MAGIC, INDEX_VERSION);
+  mIndex.write(&buffer[0], buffer.size());
+
+  return mLog.good() && mIndex.good();
+}
+
+void TrackLogWriter::close()
+{
+  if(mLog.is_open())
+    mLog.close();
+  if(mIndex.is_open())
+    mIndex.close();
+}
+
+void TrackLogWriter::writeFrame(uint32_t frameNumber, const std::vector<TrackRecord> &records)
+{
+  mAlertScratch.clear();
+  writeFrame(frameNumber, records, mAlertScratch);
+}
+
+void TrackLogWriter::writeFrame(uint32_t frameNumber, const std::vector<TrackRecord> &records,
+                                const std::vector<AlertRecord> &alerts)
+{
+  if(!isOpen())
+    return;
+
+  std::vector<char> &buffer = mBuffer;
+  buffer.clear();
+  buffer.reserve(FRAME_HEADER_SIZE + records.size() * RECORD_SIZE + alerts.size() * ALERT_SIZE);
+
+  putU32(buffer, frameNumber);
+  putU32(buffer, records.size());
+  putU32(buffer, alerts.size());
+  for(unsigned i = 0; i < records.size(); i++)
+  {
+    const TrackRecord &r = records[i];
+    putU32(buffer, (uint32_t)r.id);
+    putI16(buffer, r.x);
+    putI16(buffer, r.y);
+    putI16(buffer, r.width);
+    putI16(buffer, r.height);
+    putI16(buffer, r.pointX);
+    putI16(buffer, r.pointY);
+  }
+  for(unsigned i = 0; i < alerts.size(); i++)
+  {
+    const AlertRecord &a = alerts[i];
+    putU32(buffer, (uint32_t)a.objectId);
+    putU32(buffer, (uint32_t)a.ruleId);
+    putI16(buffer, a.eventType);
+    putI16(buffer, a.contextId);
+  }
+  mLog.write(&buffer[0], buffer.size());
+
+  // the index entry is only written after its frame, so a truncated log never has a dangling entry
+  std::vector<char> &entry = mEntry;
+  entry.clear();
+  putU32(entry, frameNumber);
+  putU64(entry, mOffset);
+  mIndex.write(&entry[0], entry.size());
+
+  mOffset += buffer.size();
+}
+
+void TrackLogWriter::writeFrame(uint32_t frameNumber, const std::vector<Object *> &objects,
+                                const AnalysisTransform &analysis, const AlertIndex *alerts)
+{
+  mScratch.resize(objects.size());
+  for(unsigned i = 0; i < objects.size(); i++)
+  {
+    Object *object = objects[i];
+    ObjectFrame *frame = object->getCurrentObjectFrame();
+    TrackRecord &r = mScratch[i];
+
+    r.id = object->getId();
+    Point topLeft = analysis.toFrameCorner(frame->getX(), frame->getY());
+    r.x = clamp16(topLeft.x);
+    r.y = clamp16(topLeft.y);
+    r.width = clamp16(frame->getWidth() * analysis.scale);
+    r.height = clamp16(frame->getHeight() * analysis.scale);
+
+    const std::vector<Point> &trajectory = object->getTrajectory();
+    Point point = trajectory.empty() ? analysis.toFrame(frame->getXCenter(), frame->getYCenter())
+                                     : analysis.toFrame(trajectory.back());
+    r.pointX = clamp16(point.x);
+    r.pointY = clamp16(point.y);
+  }
+
+  mAlertScratch.clear();
+  if(alerts != NULL)
+  {
+    for(AlertIndex::const_iterator it = alerts->begin(); it != alerts->end(); ++it)
+    {
+      AlertRecord a;
+      a.objectId = it->objectId;
+      a.ruleId = it->rule != NULL ? it->rule->getID() : -1;
+      a.eventType = it->event != NULL ? (int16_t)it->event->getType() : -1;
+      a.contextId = clamp16(it->contextId);
+      mAlertScratch.push_back(a);
+    }
+  }
+
+  writeFrame(frameNumber, mScratch, mAlertScratch);
+}
+
+// ======================
+// === TrackLogReader ===
+// ======================
+
+TrackLogReader::TrackLogReader()
+{
+  mNext = 0;
+  mVersion = 0;
+  mFrameHeaderSize = FRAME_HEADER_SIZE;
+}
+
+bool TrackLogReader::open(const std::string &fileName)
+{
+  mFrameNumbers.clear();
+  mOffsets.clear();
+  mNext = 0;
+
+  if(mLog.is_open())
+    mLog.close();
+  mLog.clear();
+
+  mLog.open(fileName.c_str(), std::ios::in | std::ios::binary);
+  if(!mLog.is_open())
+    return false;
+  mVersion = checkHeader(mLog, LOG_MAGIC);
+  if(mVersion < 1 || mVersion > LOG_VERSION)
+    return false;
+  mFrameHeaderSize = mVersion == 1 ? FRAME_HEADER_SIZE_V1 : FRAME_HEADER_SIZE;
+
+  if(!loadIndex(fileName + ".idx"))
+    rebuildIndex();
+
+  return true;
+}
+
+bool TrackLogReader::loadIndex(const std::string &indexFileName)
+{
+  std::ifstream index(indexFileName.c_str(), std::ios::in | std::ios::binary);
+  if(!index.is_open() || checkHeader(index, INDEX_MAGIC) != INDEX_VERSION)
+    return false;
+
+  unsigned char entry[INDEX_ENTRY_SIZE];
+  while(index.read((char *)entry, INDEX_ENTRY_SIZE) && index.gcount() == INDEX_ENTRY_SIZE)
+  {
+    mFrameNumbers.push_back(getU32(entry));
+    mOffsets.push_back(getU64(entry + 4));
+  }
+
+  // the index must reach the end of the log, otherwise the log was written after it
+  mLog.clear();
+  mLog.seekg(0, std::ios::end);
+  uint64_t logSize = mLog.tellg();
+
+  uint64_t indexedEnd = HEADER_SIZE;
+  if(!mOffsets.empty())
+  {
+    unsigned char frameHeader[FRAME_HEADER_SIZE];
+    mLog.seekg(mOffsets.back());
+    mLog.read((char *)frameHeader, mFrameHeaderSize);
+    if(mLog.gcount() != mFrameHeaderSize)
+      indexedEnd = logSize + 1;
+    else
+      indexedEnd = mOffsets.back() + frameSize(frameHeader);
+  }
+  mLog.clear();
+
+  if(indexedEnd != logSize)
+  {
+    mFrameNumbers.clear();
+    mOffsets.clear();
+    return false;
+  }
+  return true;
+}
+
+void TrackLogReader::rebuildIndex()
+{
+  mLog.clear();
+  mLog.seekg(0, std::ios::end);
+  uint64_t logSize = mLog.tellg();
+
+  uint64_t offset = HEADER_SIZE;
+  unsigned char frameHeader[FRAME_HEADER_SIZE];
+  while(offset + mFrameHeaderSize <= logSize)
+  {
+    mLog.seekg(offset);
+    mLog.read((char *)frameHeader, mFrameHeaderSize);
+
+    uint64_t end = offset + frameSize(frameHeader);
+    if(end > logSize)
+      break;  // truncated last frame
+
+    mFrameNumbers.push_back(getU32(frameHeader));
+    mOffsets.push_back(offset);
+    offset = end;
+  }
+  mLog.clear();
+}
+
+uint64_t TrackLogReader::frameSize(const unsigned char *frameHeader) const
+{
+  uint64_t alertCount = mVersion >= 2 ? getU32(frameHeader + 8) : 0;
+  return mFrameHeaderSize + (uint64_t)getU32(frameHeader + 4) * RECORD_SIZE + alertCount * ALERT_SIZE;
+}
+
+bool TrackLogReader::readFrame(unsigned i, std::vector<TrackRecord> &records)
+{
+  return readFrame(i, records, mAlerts);
+}
+
+bool TrackLogReader::readFrame(unsigned i, std::vector<TrackRecord> &records, std::vector<AlertRecord> &alerts)
+{
+  if(i >= mOffsets.size())
+    return false;
+
+  // sequential reads need no seek (which would drop the stream buffer)
+  unsigned char frameHeader[FRAME_HEADER_SIZE];
+  if((uint64_t)mLog.tellg() != mOffsets[i])
+    mLog.seekg(mOffsets[i]);
+  mLog.read((char *)frameHeader, mFrameHeaderSize);
+  if(mLog.gcount() != mFrameHeaderSize)
+    return false;
+
+  uint32_t count = getU32(frameHeader + 4);
+  uint32_t alertCount = mVersion >= 2 ? getU32(frameHeader + 8) : 0;
+  mBuffer.resize(count * RECORD_SIZE + alertCount * ALERT_SIZE);
+  if(!mBuffer.empty())
+  {
+    mLog.read((char *)&mBuffer[0], mBuffer.size());
+    if((uint64_t)mLog.gcount() != mBuffer.size())
+      return false;
+  }
+
+  records.resize(count);
+  for(unsigned r = 0; r < count; r++)
+  {
+    const unsigned char *p = &mBuffer[r * RECORD_SIZE];
+    TrackRecord &record = records[r];
+    record.id = (int32_t)getU32(p);
+    record.x = getI16(p + 4);
+    record.y = getI16(p + 6);
+    record.width = getI16(p + 8);
+    record.height = getI16(p + 10);
+    record.pointX = getI16(p + 12);
+    record.pointY = getI16(p + 14);
+  }
+
+  alerts.resize(alertCount);
+  for(unsigned a = 0; a < alertCount; a++)
+  {
+    const unsigned char *p = &mBuffer[count * RECORD_SIZE + a * ALERT_SIZE];
+    AlertRecord &alert = alerts[a];
+    alert.objectId = (int32_t)getU32(p);
+    alert.ruleId = (int32_t)getU32(p + 4);
+    alert.eventType = getI16(p + 8);
+    alert.contextId = getI16(p + 10);
+  }
+
+  mNext = i + 1;
+  return true;
+}
+
+int TrackLogReader::findFrame(uint32_t frameNumber) const
+{
+  // the frames are logged in increasing order
+  std::vector<uint32_t>::const_iterator it = std::upper_bound(mFrameNumbers.begin(), mFrameNumbers.end(), frameNumber);
+  return (int)(it - mFrameNumbers.begin()) - 1;
+}
+
+bool TrackLogReader::next(std::vector<TrackRecord> &records)
+{
+  return readFrame(mNext, records);
+}
+
+void TrackLogReader::rewind()
+{
+  mNext = 0;
+}
@@ -0,0 +1,193 @@
+/** \file
+  * Binary track log: the per frame tracker output (track id, bbox and
+  * trajectory point) and the alerts of the rules in a compact append-only
+  * file with a frame index, so the engine can be run on real data without
+  * decoding video, and the editor can draw the detections over the original
+  * video without a re-encoded result video.
+  *
+  * Log file:   "RBTL" version, then per frame: frame number, record count,
+  *             alert count, records, alerts (version 1 logs have no alerts).
+  * Index file: "RBTI" version, then per frame: frame number, offset in the log.
+  * All values are little endian, the index is rebuilt from the log when it is
+  * missing or shorter than the log.
+  *
+  * $Id$
+  */
+
+#ifndef TRACKLOG_HPP
+#define TRACKLOG_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstddef>
+#include <stdint.h>
+
+#include "Misc.hpp"
+
+namespace Rbe
+{
+  class Object;
+  class AlertIndex;
+
+  /**
+    * One tracked object in one frame, 16 bytes on disk.
+    */
+  struct TrackRecord
+  {
+    int32_t id;       ///< track id.
+    int16_t x;        ///< bbox left.
+    int16_t y;        ///< bbox top.
+    int16_t width;    ///< bbox width.
+    int16_t height;   ///< bbox height.
+    int16_t pointX;   ///< newest trajectory point x.
+    int16_t pointY;   ///< newest trajectory point y.
+  };
+
+  /**
+    * One alert in one frame, 12 bytes on disk.
+    */
+  struct AlertRecord
+  {
+    int32_t objectId;   ///< track id.
+    int32_t ruleId;     ///< id of the rule of the event.
+    int16_t eventType;  ///< Event::EventType of the event.
+    int16_t contextId;  ///< id of the crossed tripwire, -1 for other events.
+  };
+
+  /**
+    * Appends frames to a track log and its index.
+    */
+  class TrackLogWriter
+  {
+  public:
+    TrackLogWriter();
+    ~TrackLogWriter();
+
+    /**
+      * Create the log (and "<fileName>.idx"), an existing log is overwritten.
+      *
+      * \param[in] fileName path of the log.
+      * \return true on success.
+      */
+    bool open(const std::string &fileName);
+
+    /// Close the log and index.
+    void close();
+
+    inline bool isOpen() const {return mLog.is_open();}
+
+    /**
+      * Append one frame.
+      *
+      * \param[in] frameNumber number of the frame.
+      * \param[in] records the tracked objects in the frame.
+      */
+    void writeFrame(uint32_t frameNumber, const std::vector<TrackRecord> &records);
+
+    /**
+      * Append one frame with its alerts.
+      *
+      * \param[in] frameNumber number of the frame.
+      * \param[in] records the tracked objects in the frame.
+      * \param[in] alerts the alerts of the rules in the frame.
+      */
+    void writeFrame(uint32_t frameNumber, const std::vector<TrackRecord> &records,
+                    const std::vector<AlertRecord> &alerts);
+
+    /**
+      * Append one frame, taking the records from the engine objects (id,
+      * current object frame and last trajectory point) and the alerts from
+      * the alert index, if any. The positions are mapped by analysis, so the
+      * log is in frame coordinates when the objects were tracked on a crop
+      * or a smaller copy of the frame.
+      */
+    void writeFrame(uint32_t frameNumber, const std::vector<Object *> &objects,
+                    const AnalysisTransform &analysis = AnalysisTransform(),
+                    const AlertIndex *alerts = NULL);
+
+  private:
+    std::ofstream mLog;
+    std::ofstream mIndex;
+    uint64_t mOffset;                        ///< current end of the log.
+    std::vector<TrackRecord> mScratch;       ///< reused by writeFrame(objects).
+    std::vector<AlertRecord> mAlertScratch;  ///< reused by writeFrame(objects).
+    std::vector<char> mBuffer;               ///< reused by writeFrame.
+    std::vector<char> mEntry;                ///< index entry, reused by writeFrame.
+  };
+
+  /**
+    * Reads a track log, sequentially or by frame.
+    */
+  class TrackLogReader
+  {
+  public:
+    TrackLogReader();
+
+    /**
+      * Open a log and load (or rebuild) its index.
+      *
+      * \param[in] fileName path of the log.
+      * \return true on success.
+      */
+    bool open(const std::string &fileName);
+
+    /// number of frames in the log.
+    inline unsigned getNbFrames() const {return mFrameNumbers.size();}
+
+    /// frame number of the i-th frame in the log.
+    inline uint32_t getFrameNumber(unsigned i) const {return mFrameNumbers[i];}
+
+    /**
+      * Read the i-th frame of the log.
+      *
+      * \param[in] i index of the frame, in [0, getNbFrames()).
+      * \param[out] records the tracked objects, the vector is reused.
+      * \return true on success.
+      */
+    bool readFrame(unsigned i, std::vector<TrackRecord> &records);
+
+    /**
+      * Read the i-th frame of the log with its alerts.
+      *
+      * \param[in] i index of the frame, in [0, getNbFrames()).
+      * \param[out] records the tracked objects, the vector is reused.
+      * \param[out] alerts the alerts, empty for a version 1 log.
+      * \return true on success.
+      */
+    bool readFrame(unsigned i, std::vector<TrackRecord> &records, std::vector<AlertRecord> &alerts);
+
+    /**
+      * Index of the last frame of the log with a frame number not above
+      * frameNumber, -1 if there is none.
+      */
+    int findFrame(uint32_t frameNumber) const;
+
+    /**
+      * Read the frame following the last one read.
+      *
+      * \return false at the end of the log.
+      */
+    bool next(std::vector<TrackRecord> &records);
+
+    /// Continue reading at the first frame.
+    void rewind();
+
+  private:
+    bool loadIndex(const std::string &indexFileName);
+    void rebuildIndex();
+    /// size of a frame from its header.
+    uint64_t frameSize(const unsigned char *frameHeader) const;
+
+    std::ifstream mLog;
+    uint32_t mVersion;
+    unsigned mFrameHeaderSize;
+    std::vector<uint32_t> mFrameNumbers;
+    std::vector<uint64_t> mOffsets;
+    std::vector<unsigned char> mBuffer;  ///< reused by readFrame().
+    std::vector<AlertRecord> mAlerts;    ///< alerts of readFrame(i, records).
+    unsigned mNext;
+  };
+}
+
+#endif // TRACKLOG_HPP
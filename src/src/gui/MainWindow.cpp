@@ -10,6 +10,8 @@
 
 #include <string>
 #include <exception>
+#include <cstdlib>
+#include <algorithm>
 
 #include "src/gui/RbeItemTree.hpp"
 #include "src/gui/RbePropertyTree.hpp"
@@ -22,8 +24,13 @@
 #include "src/gui/RbeXmlHandler.hpp"
 #include "src/gui/RbeGeneralContainer.hpp"
 #include "src/gui/RbeVirtualFence.hpp"
+#include "src/gui/RbeVirtualFenceThread.hpp"
+#include "src/gui/RbePreviewQueue.hpp"
+#include "src/gui/RbeVideoBackdrop.hpp"
+#include "src/gui/RbeDetectionOverlay.hpp"
+
+#include "src/core/PolygonRasterizer.hpp"
 
-#include "extra/QTFFmpegWrapper/QVideoDecoder.h"
 
 #include "src/gui/help.cpp"
 
@@ -35,6 +42,23 @@ MainWindow::MainWindow(QWidget *parent) :
 {  
   videoFilePath = "";
   
+  virtualFence = NULL;
+  virtualFenceThread = NULL;
+  previewLabel = NULL;
+  previewQueue = new RbePreviewQueue();
+  
+  // the results of the virtual fencing thread are taken at the display rate
+  previewTimer = new QTimer(this);
+  previewTimer->setInterval(40);
+  connect(previewTimer,SIGNAL(timeout()),this,SLOT(showVirtualFencingResults()));
+  
+  // decodes the frames shown behind the contexts
+  videoBackdrop = new RbeVideoBackdrop(this);
+  connect(videoBackdrop,SIGNAL(frameReady(int,QImage)),this,SLOT(videoFrameReady(int,QImage)));
+  
+  // the tracks and alerts of a run, drawn over the video
+  detectionOverlay = new RbeDetectionOverlay();
+  
   checkAndGenerateNecessaryFile();
   createActions();
   createMenus();
@@ -145,6 +169,11 @@ void MainWindow::createActions()
   connect(openVideoAction,SIGNAL(triggered()),
           this,SLOT(openVideoFile()));
   
+  openTrackLogAction = new QAction("Open track log",this);
+  openTrackLogAction->setStatusTip("Show the detections of a run over the video");
+  connect(openTrackLogAction,SIGNAL(triggered()),
+          this,SLOT(openTrackLog()));
+  
   
   saveProjectAction= new QAction("&Save project",this);
   saveProjectAction->setIcon(QIcon(":/images/save.png"));     
@@ -207,6 +236,7 @@ void MainWindow::createMenus()
   fileMenu->addAction(newAction);
   fileMenu->addAction(openFileAction);
   fileMenu->addAction(openVideoAction);
+  fileMenu->addAction(openTrackLogAction);
   fileMenu->addAction(saveProjectAction);  
   fileMenu->addAction(exitAction);
   
@@ -267,6 +297,14 @@ void MainWindow::createToolbars()
   runToolBar = addToolBar(tr("runToolbar"));  
   //runToolBar->addAction(runAnimateAction);
   runToolBar->addAction(openVideoAction);
+  
+  videoSlider = new QSlider(Qt::Horizontal, this);
+  videoSlider->setRange(0, 0);
+  videoSlider->setMinimumWidth(200);
+  videoSlider->setEnabled(false);
+  videoSlider->setStatusTip("Frame of the video behind the contexts");
+  connect(videoSlider,SIGNAL(valueChanged(int)),this,SLOT(showVideoFrame(int)));
+  runToolBar->addWidget(videoSlider);
   runToolBar->addAction(runVirtualFencingAction);  
   //////////////////////
   QToolBar *exitToolBar;
@@ -431,39 +469,47 @@ void MainWindow::saveContextsPixmapToFile()
     return;
   }
   
-  QImage image(388,288,QImage::Format_ARGB32_Premultiplied);
-  QRect sRect(0,0,388,288);
-  QPainter painter(&image);
-  rbeVisualizeWidget->getDrawScene()->render(&painter);  
+  file.close();
   
-  //traslate pixel
-  QRgb pixColor;  
+  // the scene is in video pixels (the frame is its unscaled background),
+  // so the mask is the size of the video frame
+  QSize maskSize = videoFrameSize.isValid() ? videoFrameSize : rbeVisualizeWidget->getDrawScene()->sceneRect().size().toSize();
+  Rbe::PolygonRasterizer rasterizer(maskSize.width(), maskSize.height());
   
-  //set a mask image, keep the area color, black the rest  
-  for (int i = 0; i < image.width(); ++i)
+  // the label of an area is its context ID, 0 is black; items() is topmost
+  // first, so it is walked backwards to let the top area win an overlap
+  std::vector<Rbe::Rgb> palette(1, qRgb(0,0,0));
+  std::vector<Rbe::Point> polygon;
+  QList<QGraphicsItem *> items = rbeVisualizeWidget->getDrawScene()->items();
+  for(int k = items.size() - 1; k >= 0; k--)
   {
-    for (int j = 0; j < image.height(); ++j)
+    if(items[k]->type() != RbeVisualizeWidget_GraphicsScene::POLYGON_ITEM)
+      continue;
+    
+    RbeVisualizeWidget_PolygonItem *item = qgraphicsitem_cast<RbeVisualizeWidget_PolygonItem*>(items[k]);
+    QList<QPoint> points = item->getMapToScenePoints();
+    polygon.resize(points.size());
+    for(int i = 0; i < points.size(); i++)
     {
-      pixColor = image.pixel(i, j);      
-      bool value = false;
-      for(int k = 0 ; k < generalContainer->getGeneralContextItems()->size(); k++)
-      {
-        if(rbeVisualizeWidget->getDrawScene()->items()[k]->type() == RbeVisualizeWidget_GraphicsScene::POLYGON_ITEM)
-        {
-          RbeVisualizeWidget_PolygonItem *item = qgraphicsitem_cast<RbeVisualizeWidget_PolygonItem*>(rbeVisualizeWidget->getDrawScene()->items()[k]);
-          if(QColor::fromRgb(pixColor) == item->getColor())   
-          {
-            value = true;
-          }
-        }        
-      }
-      if(value == false)
-      {
-        image.setPixel(i, j, qRgb(0,0,0));//set to black
-      }
+      polygon[i].x = points[i].x();
+      polygon[i].y = points[i].y();
     }
-  }   
-  image.save(fileName,"PNG");    
+    
+    // the label mask has 16 bits, context IDs are numbered from 1 up
+    uint16_t label = item->getID();
+    rasterizer.fill(polygon, label);
+    if(palette.size() <= label)
+      palette.resize(label + 1, qRgb(0,0,0));
+    palette[label] = item->getColor().rgba();
+  }
+  
+  // the label mask (context ID per pixel) is written next to the color mask
+  QString labelFileName = QFileInfo(fileName).path() + "/" + QFileInfo(fileName).completeBaseName() + "_labels.png";
+  if(!rasterizer.savePng(labelFileName.toStdString(), fileName.toStdString(), palette))
+  {
+    QMessageBox::warning(this, tr("Save mask image"),
+                         tr("Cannot save file %1.").arg(fileName));
+  }
 }
 
 void MainWindow::openFile(bool popup)
@@ -508,44 +554,76 @@ void MainWindow::openVideoFile()
     return;  
   
   
-  QVideoDecoder decoder;  
-  decoder.openFile(fileName);
-  if(decoder.isOk()==false)
+  // the decoder stays open for scrubbing through the video
+  QImage img;
+  if(!videoBackdrop->open(fileName, img))
   {
     QMessageBox::critical(this,"Error","Error loading the video");
     return;
   }
   
-  if(!decoder.seekNextFrame())
-  {
-    QMessageBox::critical(this,"Error","seekNextFrame failed");
-  }
+  videoFrameSize = img.size();
+  setVideoBackground(img);
   
+  videoSlider->blockSignals(true);
+  videoSlider->setRange(0, std::max(0, videoBackdrop->getLastFrameNumber()));
+  videoSlider->setValue(0);
+  videoSlider->blockSignals(false);
+  videoSlider->setEnabled(true);
   
-  QImage img;
-  // Decode a frame
-  int et,en;
-  if(!decoder.getFrame(img,&en,&et))
+  videoFilePath = fileName;
+  showDetections(0);
+}
+
+void MainWindow::openTrackLog()
+{
+  QString fileName = QFileDialog::getOpenFileName(this, 
+                                                  tr("Open track log"),
+                                                  "./data/.temp/VirtualFence/tracks.rbt",
+                                                  tr("*.rbt"));
+  
+  if (fileName.isEmpty())
+    return;
+  
+  if(!detectionOverlay->open(fileName))
   {
-    QMessageBox::critical(this,"Error","Error decoding the frame");
+    QMessageBox::critical(this,"Error","Error loading the track log");
     return;
   }
   
-  decoder.close();
-  
-  //now display image
-  // Convert the QImage to a QPixmap for display
-  QPixmap pixmap;  
-  pixmap = QPixmap(img.size());
-  QPainter painter;
-  painter.begin(&pixmap);
-  painter.drawImage(0,0,img);
-  painter.end();   
-  
-  //this->rbeVisualizeWidget->getDrawScene()->addPixmap(pixmap);
-  this->rbeVisualizeWidget->getDrawScene()->setBackgroundBrush(QBrush(QPixmap(pixmap)));
+  showDetections(videoSlider->value());
+}
+
+void MainWindow::showDetections(int frameNumber)
+{
+  this->rbeVisualizeWidget->getDrawScene()->setOverlay(detectionOverlay->boxesAt(frameNumber));
+}
+
+void MainWindow::setVideoBackground(const QImage &image)
+{
+  this->rbeVisualizeWidget->getDrawScene()->setBackgroundBrush(QBrush(QPixmap::fromImage(image)));
+}
+
+void MainWindow::showVideoFrame(int frameNumber)
+{
+  QImage img;
+  if(videoBackdrop->requestFrame(frameNumber, img))
+  {
+    setVideoBackground(img);
+    showDetections(frameNumber);
+  }
   
-  videoFilePath = fileName;
+  statusBar()->showMessage(tr("Frame %1").arg(frameNumber), 2000);
+}
+
+void MainWindow::videoFrameReady(int frameNumber, const QImage &image)
+{
+  // a frame the slider already moved past is not shown
+  if(frameNumber == videoSlider->value())
+  {
+    setVideoBackground(image);
+    showDetections(frameNumber);
+  }
 }
 
 void MainWindow::newFile()
@@ -560,6 +638,11 @@ void MainWindow::newFile()
   
   //clear filepath
   videoFilePath = "";      
+  videoFrameSize = QSize();
+  videoBackdrop->close();
+  videoSlider->setEnabled(false);
+  detectionOverlay->close();
+  this->rbeVisualizeWidget->getDrawScene()->setOverlay(QList<RbeOverlayBox>());
 }
 
 void MainWindow::newRule()
@@ -590,6 +673,14 @@ void MainWindow::runAnimate()
 
 void MainWindow::runVirtualFencing()
 {
+  if(virtualFenceThread != NULL)
+  {
+    QMessageBox box;
+    box.setText("Virtual fencing is already running");
+    box.exec();
+    return;
+  }
+  
   if(generalContainer->getGeneralContextItems()->size() == 0)
   {
     QMessageBox box;
@@ -618,17 +709,73 @@ void MainWindow::runVirtualFencing()
   
   generalContainer->clearRuleTree();
   
-  RbeVirtualFence *dialog = new RbeVirtualFence(this);  
-  dialog->mainW = this;
+  virtualFence = new RbeVirtualFence(this);  
+  virtualFence->mainW = this;
+  
+  virtualFence->videoFilePath = this->videoFilePath; 
+  virtualFence->setPreviewQueue(previewQueue);
   
-  dialog->videoFilePath = this->videoFilePath; 
-  dialog->run();
+  // the video is processed in its own thread, the editor stays responsive
+  virtualFenceThread = new RbeVirtualFenceThread(virtualFence, this);
+  connect(virtualFenceThread,SIGNAL(finished()),this,SLOT(virtualFencingFinished()));
+  runVirtualFencingAction->setEnabled(false);
+  previewTimer->start();
+  virtualFenceThread->start();
+}
+
+void MainWindow::showVirtualFencingResults()
+{
+  QImage image;
+  quint64 frameNumber;
+  if(previewQueue->takeFrame(image, frameNumber))
+  {
+    if(previewLabel == NULL)
+    {
+      previewLabel = new QLabel();
+      previewLabel->setWindowTitle("Virtual fencing");
+    }
+    previewLabel->setPixmap(QPixmap::fromImage(image));
+    previewLabel->resize(image.size());
+    previewLabel->show();
+  }
+  
+  // only the newest alerts are shown
+  QList<RbeAlertSummary> alerts = previewQueue->takeAlerts();
+  if(!alerts.isEmpty())
+  {
+    const RbeAlertSummary &last = alerts.last();
+    statusBar()->showMessage(tr("Frame %1: %2").arg(last.frameNumber).arg(last.alerts.join(", ")), 5000);
+  }
+}
+
+void MainWindow::virtualFencingFinished()
+{
+  previewTimer->stop();
+  showVirtualFencingResults();
+  
+  if(virtualFenceThread->getResult() != EXIT_SUCCESS)
+    QMessageBox::warning(this, tr("Virtual fencing"), tr("Virtual fencing stopped with an error, see the console."));
+  
+  virtualFenceThread->deleteLater();
+  virtualFenceThread = NULL;
+  virtualFence->deleteLater();
+  virtualFence = NULL;
+  
+  runVirtualFencingAction->setEnabled(true);
 }
 
 
 MainWindow::~MainWindow()
 {
+  if(virtualFenceThread != NULL)
+  {
+    virtualFenceThread->stop();
+    virtualFenceThread->wait();
+  }
   
+  delete previewLabel;
+  delete previewQueue;
+  delete detectionOverlay;
 }
 
 
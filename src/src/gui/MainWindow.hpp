@@ -13,6 +13,11 @@ class RbePropertyTree;
 class RbeVisualizeWidget;
 class RbeXmlHandler;
 class RbeGeneralContainer;
+class RbeVirtualFence;
+class RbeVirtualFenceThread;
+class RbePreviewQueue;
+class RbeVideoBackdrop;
+class RbeDetectionOverlay;
 
 
 class MainWindow : public QMainWindow
@@ -44,6 +49,7 @@ private:
     QAction *newAction;    
     QAction *openFileAction;     
     QAction *openVideoAction; 
+    QAction *openTrackLogAction;
     QAction *saveAction;    
     QAction *saveContextsAction;    
     QAction *saveContextsPixmapAction;    
@@ -59,12 +65,25 @@ private:
     QButtonGroup *contextItemsButtonGroup;
     
     QString videoFilePath;
+    QSize videoFrameSize;  ///< size of the frames of the video, invalid without video.
+    RbeVideoBackdrop *videoBackdrop;
+    QSlider *videoSlider;
+    RbeDetectionOverlay *detectionOverlay;
+    
+    // the running virtual fencing (NULL when not running) and its results
+    RbeVirtualFence *virtualFence;
+    RbeVirtualFenceThread *virtualFenceThread;
+    RbePreviewQueue *previewQueue;
+    QTimer *previewTimer;
+    QLabel *previewLabel;
     
     void checkAndGenerateNecessaryFile();
     void createActions();
     void createMenus();
     void createToolbars();  
     void createSubViewsAndLayoutAndConnection();    
+    void setVideoBackground(const QImage &image);
+    void showDetections(int frameNumber);
     
 signals:
     
@@ -77,7 +96,10 @@ private slots:
     void saveContextsPixmapToFile();
     void openFile(bool popup=true);        
     void openVideoFile();
+    void openTrackLog();
     void newFile();
+    void showVideoFrame(int frameNumber);
+    void videoFrameReady(int frameNumber, const QImage &image);
     void newRule();
     void exit();
     void about();
@@ -86,6 +108,8 @@ private slots:
     
     void runAnimate();
     void runVirtualFencing();
+    void showVirtualFencingResults();
+    void virtualFencingFinished();
     
     
     
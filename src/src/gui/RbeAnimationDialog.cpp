@@ -79,7 +79,7 @@ void RbeAnimationDialog::drawMask()
         if(rbeEngine->getContexts()[k]->getType() == Rbe::Context::AREA)
         {
           Rbe::ContextArea *area = static_cast<Rbe::ContextArea *>(rbeEngine->getContexts()[k]);
-          if(QColor::fromRgb(pixColor) == area->getColor())   
+          if(pixColor == area->getRgbColorValue())   
           {
             value = true;
           }
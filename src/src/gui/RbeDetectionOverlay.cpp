@@ -0,0 +1,67 @@
+#include "RbeDetectionOverlay.hpp"
+
+#include "src/core/Event.hpp"
+
+RbeDetectionOverlay::RbeDetectionOverlay(int maxGap)
+{
+  mOpen = false;
+  mMaxGap = maxGap;
+  mIndex = -1;
+}
+
+bool RbeDetectionOverlay::open(const QString &fileName)
+{
+  close();
+  mOpen = mReader.open(fileName.toStdString());
+  return mOpen;
+}
+
+void RbeDetectionOverlay::close()
+{
+  mOpen = false;
+  mIndex = -1;
+  mBoxes.clear();
+}
+
+QList<RbeOverlayBox> RbeDetectionOverlay::boxesAt(int frameNumber)
+{
+  if(!mOpen || frameNumber < 0)
+    return QList<RbeOverlayBox>();
+
+  int index = mReader.findFrame(frameNumber);
+  if(index < 0 || frameNumber - (int)mReader.getFrameNumber(index) > mMaxGap)
+    return QList<RbeOverlayBox>();
+
+  // the same log frame is shown for the frames the run skipped
+  if(index == mIndex)
+    return mBoxes;
+
+  mIndex = -1;
+  mBoxes.clear();
+  if(!mReader.readFrame(index, mRecords, mAlerts))
+    return mBoxes;
+
+  for(unsigned i = 0; i < mRecords.size(); i++)
+  {
+    const Rbe::TrackRecord &r = mRecords[i];
+    RbeOverlayBox box;
+    box.box = QRect(r.x, r.y, r.width, r.height);
+    box.point = QPoint(r.pointX, r.pointY);
+    box.label = QString("id %1").arg(r.id);
+    box.alert = false;
+
+    // an object with several alerts shows them all
+    for(unsigned a = 0; a < mAlerts.size(); a++)
+    {
+      if(mAlerts[a].objectId != r.id)
+        continue;
+      QString event = QString::fromStdString(Rbe::Event::getTypeString((Rbe::Event::EventType)mAlerts[a].eventType));
+      box.label += QString(box.alert ? ", %1" : ": %1").arg(event);
+      box.alert = true;
+    }
+    mBoxes.append(box);
+  }
+
+  mIndex = index;
+  return mBoxes;
+}
@@ -0,0 +1,46 @@
+#ifndef RBEDETECTIONOVERLAY_HPP
+#define RBEDETECTIONOVERLAY_HPP
+
+#include <vector>
+
+#include <QList>
+#include <QString>
+
+#include "src/core/TrackLog.hpp"
+#include "src/gui/RbeVisualizeWidget_GraphicsScene.hpp"
+
+/**
+  * The detections of a run of the virtual fencing, drawn over the video in
+  * the editor.
+  *
+  * Reads the track log the run wrote next to (or instead of) the result
+  * video, so the original video is shown with the tracks and alerts of the
+  * run, without a second decode and encode. A frame shows the last logged
+  * frame up to maxGap frames before it, so frames the run skipped keep the
+  * detections of the frame before.
+  */
+class RbeDetectionOverlay
+{
+public:
+  explicit RbeDetectionOverlay(int maxGap = 25);
+
+  bool open(const QString &fileName);
+  void close();
+
+  bool isOpen() const {return mOpen;}
+
+  /// the detections to draw on the frame, empty when there are none.
+  QList<RbeOverlayBox> boxesAt(int frameNumber);
+
+private:
+  Rbe::TrackLogReader mReader;
+  bool mOpen;
+  int mMaxGap;
+
+  int mIndex;                      ///< log frame of mBoxes, -1 if none.
+  QList<RbeOverlayBox> mBoxes;
+  std::vector<Rbe::TrackRecord> mRecords;
+  std::vector<Rbe::AlertRecord> mAlerts;
+};
+
+#endif // RBEDETECTIONOVERLAY_HPP
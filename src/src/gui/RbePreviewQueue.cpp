@@ -0,0 +1,75 @@
+#include "RbePreviewQueue.hpp"
+
+#include <QMutexLocker>
+
+RbePreviewQueue::RbePreviewQueue(int maxAlerts)
+{
+  mFrameNumber = 0;
+  mHasFrame = false;
+  mMaxAlerts = maxAlerts;
+  mDroppedFrames = 0;
+  mDroppedAlerts = 0;
+}
+
+bool RbePreviewQueue::wantsFrame() const
+{
+  QMutexLocker lock(&mMutex);
+  return !mHasFrame;
+}
+
+void RbePreviewQueue::postFrame(const QImage &image, quint64 frameNumber)
+{
+  QMutexLocker lock(&mMutex);
+  if(mHasFrame)
+    mDroppedFrames++;
+
+  mFrame = image;
+  mFrameNumber = frameNumber;
+  mHasFrame = true;
+}
+
+void RbePreviewQueue::postAlerts(const RbeAlertSummary &summary)
+{
+  QMutexLocker lock(&mMutex);
+  if(mAlerts.size() >= mMaxAlerts)
+  {
+    mAlerts.removeFirst();
+    mDroppedAlerts++;
+  }
+  mAlerts.append(summary);
+}
+
+bool RbePreviewQueue::takeFrame(QImage &image, quint64 &frameNumber)
+{
+  QMutexLocker lock(&mMutex);
+  if(!mHasFrame)
+    return false;
+
+  // the image data moves to the GUI, the slot keeps no reference to it
+  image = mFrame;
+  mFrame = QImage();
+  frameNumber = mFrameNumber;
+  mHasFrame = false;
+  return true;
+}
+
+QList<RbeAlertSummary> RbePreviewQueue::takeAlerts()
+{
+  QMutexLocker lock(&mMutex);
+  // implicitly shared, nothing is copied
+  QList<RbeAlertSummary> alerts = mAlerts;
+  mAlerts.clear();
+  return alerts;
+}
+
+int RbePreviewQueue::getDroppedFrames() const
+{
+  QMutexLocker lock(&mMutex);
+  return mDroppedFrames;
+}
+
+int RbePreviewQueue::getDroppedAlerts() const
+{
+  QMutexLocker lock(&mMutex);
+  return mDroppedAlerts;
+}
@@ -0,0 +1,60 @@
+#ifndef RBEPREVIEWQUEUE_HPP
+#define RBEPREVIEWQUEUE_HPP
+
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QStringList>
+
+/**
+  * The alerts of one frame, as shown in the editor.
+  */
+struct RbeAlertSummary
+{
+  quint64 frameNumber;
+  QStringList alerts;  ///< one "<event> object <id>" entry per alert.
+};
+
+/**
+  * Hands results from the virtual fencing thread to the GUI thread.
+  *
+  * Bounded and coalescing, so the analysis never waits on the GUI: there is
+  * one preview slot, a new preview replaces one the GUI did not take yet,
+  * and at most maxAlerts alert summaries are kept, the oldest is dropped.
+  * The GUI polls it with a timer.
+  */
+class RbePreviewQueue
+{
+public:
+  explicit RbePreviewQueue(int maxAlerts = 256);
+
+  /// true when the preview slot is empty, a producer can skip making a preview otherwise.
+  bool wantsFrame() const;
+
+  void postFrame(const QImage &image, quint64 frameNumber);
+  void postAlerts(const RbeAlertSummary &summary);
+
+  /// take the waiting preview, false if there is none.
+  bool takeFrame(QImage &image, quint64 &frameNumber);
+
+  /// take all waiting alert summaries, oldest first.
+  QList<RbeAlertSummary> takeAlerts();
+
+  int getDroppedFrames() const;
+  int getDroppedAlerts() const;
+
+private:
+  mutable QMutex mMutex;
+
+  QImage mFrame;
+  quint64 mFrameNumber;
+  bool mHasFrame;
+
+  QList<RbeAlertSummary> mAlerts;
+  int mMaxAlerts;
+
+  int mDroppedFrames;
+  int mDroppedAlerts;
+};
+
+#endif // RBEPREVIEWQUEUE_HPP
@@ -0,0 +1,158 @@
+#include "RbeVideoBackdrop.hpp"
+
+#include <algorithm>
+
+#include <QMutexLocker>
+
+#include "extra/QTFFmpegWrapper/QVideoDecoder.h"
+
+RbeVideoBackdrop::RbeVideoBackdrop(QObject *parent, int cacheMegabytes, int aheadFrames) :
+  QThread(parent)
+{
+  mDecoder = NULL;
+  mLastFrame = -1;
+  mAheadFrames = aheadFrames;
+
+  mCache.setMaxCost(cacheMegabytes * 1024);
+  mRequested = -1;
+  mAheadNext = 0;
+  mAheadEnd = -1;
+  mStop = false;
+}
+
+RbeVideoBackdrop::~RbeVideoBackdrop()
+{
+  close();
+}
+
+bool RbeVideoBackdrop::open(const QString &fileName, QImage &firstFrame)
+{
+  close();
+
+  mDecoder = new QVideoDecoder();
+  mDecoder->setIndexing(true, true);
+  if(!mDecoder->openFile(fileName))
+  {
+    close();
+    return false;
+  }
+  mLastFrame = (int)mDecoder->getLastFrameNumber();
+
+  int frameNumber;
+  if(!mDecoder->seekNextFrame() || !mDecoder->getFrame(firstFrame, &frameNumber))
+  {
+    close();
+    return false;
+  }
+  cache(frameNumber, firstFrame);
+
+  mStop = false;
+  mAheadNext = frameNumber + 1;
+  mAheadEnd = std::min(frameNumber + mAheadFrames, mLastFrame);
+  start(QThread::LowPriority);
+  return true;
+}
+
+void RbeVideoBackdrop::close()
+{
+  if(isRunning())
+  {
+    {
+      QMutexLocker lock(&mMutex);
+      mStop = true;
+      mWake.wakeOne();
+    }
+    wait();
+  }
+
+  delete mDecoder;
+  mDecoder = NULL;
+  mLastFrame = -1;
+
+  QMutexLocker lock(&mMutex);
+  mCache.clear();
+  mRequested = -1;
+  mAheadNext = 0;
+  mAheadEnd = -1;
+}
+
+bool RbeVideoBackdrop::requestFrame(int frameNumber, QImage &image)
+{
+  QMutexLocker lock(&mMutex);
+  if(mDecoder == NULL)
+    return false;
+
+  QImage *cached = mCache.object(frameNumber);
+  if(cached != NULL)
+  {
+    image = *cached;
+
+    // stay ahead of the frame that is looked at
+    mAheadNext = frameNumber + 1;
+    mAheadEnd = std::min(frameNumber + mAheadFrames, mLastFrame);
+    mWake.wakeOne();
+    return true;
+  }
+
+  // replaces a request that was not started yet
+  mRequested = frameNumber;
+  mWake.wakeOne();
+  return false;
+}
+
+void RbeVideoBackdrop::run()
+{
+  QMutexLocker lock(&mMutex);
+  while(!mStop)
+  {
+    int frameNumber;
+    bool requested = mRequested >= 0;
+    if(requested)
+    {
+      frameNumber = mRequested;
+      mRequested = -1;
+      mAheadNext = frameNumber + 1;
+      mAheadEnd = std::min(frameNumber + mAheadFrames, mLastFrame);
+    }
+    else if(mAheadNext <= mAheadEnd)
+      frameNumber = mAheadNext++;
+    else
+    {
+      mWake.wait(&mMutex);
+      continue;
+    }
+
+    QImage image;
+    QImage *cached = mCache.object(frameNumber);
+    bool found = cached != NULL;
+    if(found)
+      image = *cached;
+
+    lock.unlock();
+    if(!found)
+    {
+      found = decode(frameNumber, image);
+      if(found)
+        cache(frameNumber, image);
+    }
+    if(found && requested)
+      emit frameReady(frameNumber, image);
+    lock.relock();
+
+    // stop decoding ahead at the end of the video or an error
+    if(!found)
+      mAheadEnd = mAheadNext - 1;
+  }
+}
+
+bool RbeVideoBackdrop::decode(int frameNumber, QImage &image)
+{
+  // the decoder itself chooses between decoding forward and seeking
+  return mDecoder->seekFrame(frameNumber) && mDecoder->getFrame(image);
+}
+
+void RbeVideoBackdrop::cache(int frameNumber, const QImage &image)
+{
+  QMutexLocker lock(&mMutex);
+  mCache.insert(frameNumber, new QImage(image), std::max(1, image.byteCount() / 1024));
+}
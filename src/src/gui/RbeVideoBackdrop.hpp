@@ -0,0 +1,72 @@
+#ifndef RBEVIDEOBACKDROP_HPP
+#define RBEVIDEOBACKDROP_HPP
+
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+class QVideoDecoder;
+
+/**
+  * The video behind the contexts in the editor.
+  *
+  * Keeps one decoder open per video and decodes in its own thread: a
+  * requested frame is decoded first, then the frames after it are decoded
+  * ahead. Decoded frames are kept in an LRU cache, so scrubbing back and
+  * forth is served from memory. A request replaces the previous one that
+  * was not started yet, so the decoder never lags behind a moving slider.
+  * The key frame index of the decoder is kept next to the video, so it is
+  * only built the first time a video is opened.
+  *
+  * Frame numbers are those of the decoder (the time stamps of the video
+  * stream, which count frames for AVI).
+  */
+class RbeVideoBackdrop : public QThread
+{
+  Q_OBJECT
+public:
+  explicit RbeVideoBackdrop(QObject *parent = 0, int cacheMegabytes = 128, int aheadFrames = 25);
+  ~RbeVideoBackdrop();
+
+  /// open the video, index its key frames and decode its first frame.
+  bool open(const QString &fileName, QImage &firstFrame);
+  void close();
+
+  bool isOpen() const {return mDecoder != NULL;}
+
+  /// largest frame number in the video, -1 when no video is open.
+  int getLastFrameNumber() const {return mLastFrame;}
+
+  /**
+    * Returns true and the frame when it is cached. Otherwise the frame is
+    * decoded in the background and frameReady() is emitted when it is done.
+    */
+  bool requestFrame(int frameNumber, QImage &image);
+
+signals:
+  void frameReady(int frameNumber, const QImage &image);
+
+protected:
+  void run();
+
+private:
+  bool decode(int frameNumber, QImage &image);
+  void cache(int frameNumber, const QImage &image);
+
+  QVideoDecoder *mDecoder;   ///< only used by the thread while it runs.
+  int mLastFrame;
+  int mAheadFrames;
+
+  QMutex mMutex;             ///< guards the members below.
+  QWaitCondition mWake;
+  QCache<int, QImage> mCache; ///< cost in kilobytes.
+  int mRequested;            ///< -1 when there is no request.
+  int mAheadNext;            ///< next frame to decode ahead, up to mAheadEnd.
+  int mAheadEnd;
+  bool mStop;
+};
+
+#endif // RBEVIDEOBACKDROP_HPP
@@ -2,6 +2,10 @@
 
 #include <string>
 #include <exception>
+#include <fstream>
+#include <stdexcept>
+
+#include <boost/scoped_ptr.hpp>
 
 #include <ViNotion/VideoInputVideoFile.hpp>
 #include <ViNotion/Image.hpp>
@@ -10,6 +14,9 @@
 #include <ViNotion/Font.hpp>
 #include <ViNotion/Timer.hpp>
 #include <ViNotion/ImageFile.hpp>
+#include <ViNotion/ColorSpaceConv.hpp>
+
+#include <Settings/Settings.hpp>
 
 #include "src/core/Engine.hpp"
 #include "src/core/Object.hpp"
@@ -17,12 +24,115 @@
 #include "src/core/Rule.hpp"
 #include "src/core/EventContainer.hpp"
 #include "src/core/Misc.hpp"
+#include "src/core/Trace.hpp"
+#include "src/core/TrackLog.hpp"
 
 #include "vinotion/VirtualFencing/VirtualFencing.hpp"
 
+#include "src/video/ClipRecorder.hpp"
+#include "src/video/FramePool.hpp"
+#include "src/video/AsyncFrameWriter.hpp"
+#include "src/video/ProcessingRoi.hpp"
+#include "src/video/FrameScaler.hpp"
+#include "src/video/MotionGate.hpp"
+#include "src/video/LoadShedder.hpp"
+
 #include "src/gui/RuleProcessingPanel.hpp"
 #include "src/gui/RbeGeneralContainer.hpp"
+#include "src/gui/RbePreviewQueue.hpp"
 
+namespace
+{
+  /// width of the preview frames posted to the GUI.
+  const unsigned PREVIEW_WIDTH = 384;
+  
+  /// read an optional setting, value is left untouched when it is missing.
+  template<typename T>
+  void readSetting(const Vi::Settings &settings, const std::string &name, T &value)
+  {
+    Vi::Parameter param;
+    if(settings.getParameter(name, param))
+      param.getValue(value);
+  }
+  
+  /**
+    * What is drawn, shown and encoded. NONE only runs the rules, ALERTS only
+    * draws the objects that triggered and only shows and writes those frames.
+    */
+  enum OutputMode
+  {
+    OUTPUT_NONE,
+    OUTPUT_ALERTS,
+    OUTPUT_FULL
+  };
+  
+  OutputMode parseOutputMode(const std::string &mode)
+  {
+    if(mode == "none")
+      return OUTPUT_NONE;
+    if(mode == "alerts")
+      return OUTPUT_ALERTS;
+    if(mode == "full")
+      return OUTPUT_FULL;
+    throw std::runtime_error("unknown Output_mode " + mode + " (none, alerts or full)");
+  }
+  
+  /// a tracker bounding box in frame coordinates.
+  Vi::Bbox<int> toFrame(const Rbe::AnalysisTransform &analysis, const Vi::Bbox<int> &bbox)
+  {
+    Rbe::Point p1 = analysis.toFrameCorner(bbox.p1.x, bbox.p1.y);
+    Rbe::Point p2 = analysis.toFrameCorner(bbox.p2.x, bbox.p2.y);
+    // p2 is inside the box, so it covers scale frame pixels
+    return Vi::Bbox<int>(p1.x, p1.y, p2.x + analysis.scale - 1, p2.y + analysis.scale - 1);
+  }
+  
+  /// draw the last length segments of a trajectory in frame coordinates.
+  void drawTrajectory(Vi::Image<> &image, const Rbe::AnalysisTransform &analysis,
+                      const std::vector<Rbe::Point> &trajectory, unsigned length, Vi::YCCColor color)
+  {
+    unsigned first = trajectory.size() > length + 1 ? trajectory.size() - length - 1 : 0;
+    for(unsigned i = first; i + 1 < trajectory.size(); i++)
+    {
+      Rbe::Point p0 = analysis.toFrame(trajectory[i]);
+      Rbe::Point p1 = analysis.toFrame(trajectory[i + 1]);
+      Vi::drawLine(image, p0.x, p0.y, p1.x, p1.y, color);
+    }
+  }
+  
+  /// the frame at most width pixels wide (every n-th pixel), as RGB for the GUI.
+  QImage makePreview(const Vi::Image<> &frame, unsigned width)
+  {
+    unsigned step = (frame.w() + width - 1) / width;
+    if(step == 0)
+      step = 1;
+    
+    QImage image(frame.w() / step, frame.h() / step, QImage::Format_RGB32);
+    for(int y = 0; y < image.height(); y++)
+    {
+      const uint8_t *Y = frame.Y(y * step);
+      const uint8_t *Cb = frame.Cb(y * step);
+      const uint8_t *Cr = frame.Cr(y * step);
+      QRgb *line = (QRgb *)image.scanLine(y);
+      for(int x = 0; x < image.width(); x++)
+      {
+        uint8_t r, g, b;
+        Vi::YCbCr_2_RGB(r, g, b, Y[x * step], Cb[x * step], Cr[x * step]);
+        line[x] = qRgb(r, g, b);
+      }
+    }
+    return image;
+  }
+  
+  /// write the engine statistics as JSON to file and as text to stdout.
+  void dumpEngineStats(Rbe::Engine *engine, const std::string &fileName)
+  {
+    std::ofstream file(fileName.c_str());
+    if(file.is_open())
+      engine->dumpStatsJson(file);
+    
+    engine->dumpStatsText(std::cout);
+  }
+}
 
 RbeVirtualFence::RbeVirtualFence(QWidget *parent) :
   QDialog(parent)
@@ -35,6 +145,8 @@ RbeVirtualFence::RbeVirtualFence(QWidget *parent) :
   //  panel->activateWindow();
   
   videoFilePath = "";
+  mPreviewQueue = NULL;
+  mStopRequested = 0;
   engine = new Rbe::Engine();
   engine->readContextFile("./data/.temp/contexts.xml");
   engine->readRuleFile("./data/.temp/rules.xml");  
@@ -55,9 +167,23 @@ int RbeVirtualFence::run()
     // the timer
     Vi::Timer frameTimer;
     
+    Vi::Settings settings("./data/.temp/VirtualFence/config.ini");
+    
+    // output mode, none skips all drawing, display and encoding
+    std::string outputModeName = "full";
+    uint32_t bitrate = 5000000;
+    uint32_t outputMaxQueued = 8;
+    bool outputDropWhenFull = false;
+    readSetting(settings, "Output_mode", outputModeName);
+    readSetting(settings, "Output_bitRate", bitrate);
+    readSetting(settings, "Output_maxQueuedFrames", outputMaxQueued);
+    readSetting(settings, "Output_dropWhenFull", outputDropWhenFull);
+    OutputMode outputMode = parseOutputMode(outputModeName);
+    
     // The markup font for drawing text
     Vi::Font markupFont;
-    markupFont.init(NULL, 0, 14);
+    if(outputMode != OUTPUT_NONE)
+      markupFont.init(NULL, 0, 14);
     
     // the video input 
     Vi::VideoInputVideoFile videoInput;
@@ -67,64 +193,278 @@ int RbeVirtualFence::run()
     // Create display related stuff
     unsigned int markupFrameWidth = videoInput.getWidth();
     unsigned int markupFrameHeight = videoInput.getHeight();
-    Vi::VideoOutputDisplay vidDisplay(640, 640, markupFrameWidth, markupFrameHeight, 0);
-    
-    // markup to be displayed on output
-    Vi::Image<> currentFrameMarkup;
-    currentFrameMarkup.size(markupFrameWidth, markupFrameHeight);
-    currentFrameMarkup.clear();
+    boost::scoped_ptr<Vi::VideoOutputDisplay> vidDisplay;
     
     ///dai code///: disable clone video
     
-    // the video output
-    Vi::VideoOutputVideoFile outputFile;
-    unsigned int bitrate = 5000000;
-    outputFile.open(videoInput.getWidth(), videoInput.getHeight(), "./data/.temp/VirtualFence/result.avi", Vi::Frac<>(25), bitrate);
+    // the frames are decoded into pool buffers and passed on as handles; the
+    // pool outlives the output, which may still hold handles
+    Rbe::FramePool framePool(markupFrameWidth, markupFrameHeight, 4);
+    
+    // clips around the frames with an alert, encoded once into a ring of packets
+    bool recordingEnable = false;
+    uint32_t recordingSeconds = 4;
+    uint32_t recordingFps = 25;
+    uint32_t recordingBitRate = 5000000;
+    std::string recordingPrefix = "./data/.temp/VirtualFence/clip_";
+    readSetting(settings, "Recording_clipEnable", recordingEnable);
+    readSetting(settings, "Recording_nbSecondsAroundEvent", recordingSeconds);
+    readSetting(settings, "Recording_fpsInput", recordingFps);
+    readSetting(settings, "Recording_bitRate", recordingBitRate);
+    readSetting(settings, "Recording_clipPrefix", recordingPrefix);
+    
+    Rbe::ClipRecorder clipRecorder;
+    if(recordingEnable && !clipRecorder.open(videoInput.getWidth(), videoInput.getHeight(), recordingFps, recordingBitRate, recordingSeconds, recordingPrefix))
+      std::cout << "Error: cannot open the clip encoder" << std::endl;
+    
+    // the clips are the recording then, the result video would encode every frame a second time
+    if(clipRecorder.isOpen() && outputMode != OUTPUT_NONE)
+      std::cout << "Recording clips, result.avi is not written" << std::endl;
     
+    // the video output, encoded on its own thread from the pool frames
+    Rbe::AsyncFrameWriter outputFile;
+    
+    if(outputMode != OUTPUT_NONE)
+    {
+      vidDisplay.reset(new Vi::VideoOutputDisplay(640, 640, markupFrameWidth, markupFrameHeight, 0));
+      
+      if(!clipRecorder.isOpen())
+        outputFile.open(videoInput.getWidth(), videoInput.getHeight(), "./data/.temp/VirtualFence/result.avi", Vi::Frac<>(25), bitrate,
+                        outputMaxQueued, outputDropWhenFull);
+    }
     
     // the frame counter
     unsigned int frameCounter = 0;
     
+    // rule engine statistics
+    bool statsEnable = false;
+    uint32_t statsDumpInterval = 0;
+    std::string statsFileName = "./data/.temp/VirtualFence/stats.json";
+    readSetting(settings, "Stats_enable", statsEnable);
+    readSetting(settings, "Stats_dumpIntervalFrames", statsDumpInterval);
+    readSetting(settings, "Stats_dumpFileName", statsFileName);
+    
+    engine->setStatsEnabled(statsEnable);
+    engine->resetStats();
+    
+    // per frame stage tracing, written when the display is paused and at the end
+    bool traceEnable = false;
+    uint32_t traceBufferSize = 65536;
+    std::string traceFileName = "./data/.temp/VirtualFence/trace.json";
+    readSetting(settings, "Trace_enable", traceEnable);
+    readSetting(settings, "Trace_bufferSize", traceBufferSize);
+    readSetting(settings, "Trace_fileName", traceFileName);
+    
+    // every run is a new thread, the trace only holds this run
+    Rbe::Trace::setEnabled(traceEnable, traceBufferSize);
+    if(traceEnable)
+    {
+      Rbe::Trace::clear();
+      Rbe::Trace::setThreadName("RbeVirtualFence");
+    }
+    bool wasPaused = false;
+    
+    // track log of the tracker output, to replay the rules without video (rbe-replay)
+    bool trackLogEnable = false;
+    std::string trackLogFileName = "./data/.temp/VirtualFence/tracks.rbt";
+    readSetting(settings, "TrackLog_enable", trackLogEnable);
+    readSetting(settings, "TrackLog_fileName", trackLogFileName);
+    
+    Rbe::TrackLogWriter trackLog;
+    if(trackLogEnable && !trackLog.open(trackLogFileName))
+      std::cout << "Error: cannot write track log " << trackLogFileName << std::endl;
+    
+    // the tracker only runs on the part of the frame around the contexts,
+    // objects are then in roi coordinates and the engine maps them back
+    bool roiEnable = false;
+    uint32_t roiMargin = 32;
+    readSetting(settings, "Roi_enable", roiEnable);
+    readSetting(settings, "Roi_margin", roiMargin);
+    
+    Rbe::ProcessingRoi roi;
+    if(roiEnable)
+      roi.compute(engine->getContexts(), roiMargin, videoInput.getWidth(), videoInput.getHeight());
+    else
+      roi.setFullFrame(videoInput.getWidth(), videoInput.getHeight());
+    engine->setAnalysisOffset(roi.getRect().x, roi.getRect().y);
+    if(!roi.isFullFrame())
+      std::cout << "Processing roi " << roi.getRect().width << "x" << roi.getRect().height
+                << " at " << roi.getRect().x << "," << roi.getRect().y << std::endl;
+    
+    // and on a downscaled copy of it, the engine maps the objects back to
+    // the frame so the contexts and rules stay at full resolution
+    uint32_t scaleFactor = 1;
+    readSetting(settings, "Scale_factor", scaleFactor);
+    
+    Rbe::FrameScaler scaler;
+    scaler.setFactor(scaleFactor);
+    engine->setAnalysisScale(scaler.getFactor());
+    const Rbe::AnalysisTransform &analysis = engine->getAnalysis();
+    bool fullFrameAnalysis = roi.isFullFrame() && scaler.getFactor() == 1;
+    Vi::Image<> analysisFrame;
+    
     // the virtual fencing processing
-    VirtualFencing virtualFencing(videoInput.getWidth(), videoInput.getHeight(), "./data/.temp/VirtualFence/config.ini"); 
+    VirtualFencing virtualFencing(scaler.scaledSize(roi.getRect().width), scaler.scaledSize(roi.getRect().height), "./data/.temp/VirtualFence/config.ini"); 
     
     ///dai code///
     virtualFencing.setEngine(engine);
     
-    // the current frame
-    Vi::Image<> currentFrame;
+    // on a static scene only one frame in a while goes through the tracker
+    // and the rules, to keep the background model current
+    bool gateEnable = false;
+    uint32_t gateRowStep = 4;
+    float gateThreshold = 2.0f;
+    uint32_t gateIdleFrames = 50;
+    uint32_t gateIdleInterval = 25;
+    readSetting(settings, "Gate_enable", gateEnable);
+    readSetting(settings, "Gate_rowStep", gateRowStep);
+    readSetting(settings, "Gate_threshold", gateThreshold);
+    readSetting(settings, "Gate_idleFrames", gateIdleFrames);
+    readSetting(settings, "Gate_idleInterval", gateIdleInterval);
+    
+    Rbe::MotionGate motionGate;
+    motionGate.configure(gateRowStep, gateThreshold, gateIdleFrames, gateIdleInterval);
+    const Rbe::AlertIndex noAlerts;
+    
+    // frames are due at their input time, when the processing falls behind
+    // by more than the budget the analysis of frames is skipped
+    bool shedEnable = false;
+    uint32_t shedLatencyBudgetMs = 200;
+    uint32_t shedMaxSkips = 10;
+    readSetting(settings, "Shed_enable", shedEnable);
+    readSetting(settings, "Shed_latencyBudgetMs", shedLatencyBudgetMs);
+    readSetting(settings, "Shed_maxConsecutiveSkips", shedMaxSkips);
+    
+    Rbe::LoadShedder loadShedder;
+    loadShedder.configure(shedLatencyBudgetMs / 1000.0, shedMaxSkips);
+    
+    // the rules run on input time, not on processing time
+    double frameRate = videoInput.getFrameRate().toFloat();
+    if(frameRate <= 0)
+      frameRate = 25;
+    double startTime = Rbe::EngineStats::now() / 1e9;
+    loadShedder.rebase(0, startTime);
+    
+    // the markup is drawn on the frame itself and the shown frame is kept for a pause
+    Rbe::FrameHandle shownFrame;
     
     // ================
     // === Let's go ===
     // ================
-    while(!vidDisplay.getQuit())
+    while((!vidDisplay || !vidDisplay->getQuit()) && mStopRequested == 0)
     {
-      if(!vidDisplay.getPaused())
+      int64_t traceFrame = frameCounter;
+      Rbe::ScopedTrace frameTrace("frame", traceFrame);
+      
+      // in alerts mode only the frames with an alert are shown and written
+      bool showFrame = outputMode == OUTPUT_FULL;
+      
+      // flush the trace when the user pauses, to inspect the frames so far
+      bool paused = vidDisplay && vidDisplay->getPaused();
+      if(traceEnable && paused && !wasPaused)
+        Rbe::Trace::flush(traceFileName);
+      if(paused)
+        frameTrace.cancel();
+      // the time spent paused does not count as lag
+      if(wasPaused && !paused)
+        loadShedder.rebase(frameCounter / frameRate, Rbe::EngineStats::now() / 1e9);
+      wasPaused = paused;
+      bool processFrame = false;
+      double frameStart = 0;
+      
+      if(!paused)
       {
+        Rbe::ScopedTrace decodeTrace("decode", traceFrame);
+        Rbe::FrameHandle frame = framePool.acquire();
+        frame->frameNumber = frameCounter;
+        Vi::Image<> &currentFrame = frame->image;
         if(!videoInput.read(currentFrame))
           break;
+        decodeTrace.end();
         
         // start the timer 
         frameTimer.start();
         
-        // do the processing 
-        virtualFencing.process(currentFrame, frameCounter);
-        
-        ///dai code/// : process rule
-        engine->processRule();
+        double frameTime = frameCounter / frameRate;
+        frameStart = Rbe::EngineStats::now() / 1e9;
+        processFrame = !shedEnable || loadShedder.shouldProcess(frameTime, frameStart);
+        // a shed frame is not drawn, shown or written, the clip ring still
+        // gets it so the clips keep the input frame rate
+        bool shedFrame = !processFrame;
+        if(shedFrame)
+          showFrame = false;
         
-        // draw overlay on objects, restricted area and trip wires
-        virtualFencing.drawMaskOverlay(currentFrame);
+        if(processFrame && gateEnable)
+        {
+          Rbe::ScopedTrace gateTrace("MotionGate::update", traceFrame);
+          roi.pushSubimage(currentFrame);
+          processFrame = motionGate.update(currentFrame);
+          roi.popSubimage(currentFrame);
+        }
         
-        ///dai code///
-        //disable origin drawTripwire
-        ///virtualFencing.drawTripWires(currentFrame, Vi::YCC_CYAN);
+        // do the processing 
+        if(processFrame)
+        {
+          Rbe::ScopedTrace processTrace("VirtualFencing::process", traceFrame);
+          if(fullFrameAnalysis)
+            virtualFencing.process(currentFrame, frameCounter);
+          else
+          {
+            roi.pushSubimage(currentFrame);
+            scaler.scale(currentFrame, analysisFrame);
+            roi.popSubimage(currentFrame);
+            virtualFencing.process(analysisFrame, frameCounter);
+          }
+          processTrace.end();
+          
+          ///dai code/// : process rule
+          Rbe::ScopedTrace ruleTrace("Engine::processRule", traceFrame);
+          engine->setFrameTime(frameTime);
+          engine->processRule();
+          ruleTrace.end();
+          
+          // after the rules, so the log carries the alerts of the frame
+          if(trackLog.isOpen())
+            trackLog.writeFrame(frameCounter, engine->getObjects(), analysis, &engine->getAlerts());
+        }
         
-        ///dai code///
-        virtualFencing.drawRbeTripwire(currentFrame,Vi::YCC_CYAN);
+        // a skipped frame has no alerts, the engine still holds those of the last processed one
+        const Rbe::AlertIndex &alerts = processFrame ? engine->getAlerts() : noAlerts;
+        if(outputMode == OUTPUT_ALERTS && !alerts.empty())
+          showFrame = true;
         
+        // the clips get the frame as decoded, before the overlay is drawn on it
+        if(clipRecorder.isOpen())
+        {
+          Rbe::ScopedTrace recordTrace("ClipRecorder::write", traceFrame);
+          clipRecorder.write(currentFrame, frameCounter, !alerts.empty());
+        }
         
-        virtualFencing.drawOverlayOnObjects(currentFrame);
+        // draw overlay on objects, restricted area and trip wires
+        Rbe::ScopedTrace overlayTrace("overlay", traceFrame);
+        if(outputMode == OUTPUT_FULL && !shedFrame)
+        {
+          ///dai code///
+          //disable origin drawTripwire
+          ///virtualFencing.drawTripWires(currentFrame, Vi::YCC_CYAN);
+          
+          ///dai code///
+          virtualFencing.drawRbeTripwire(currentFrame,Vi::YCC_CYAN);
+          
+          // the tracker draws in roi coordinates, it cannot draw scaled
+          if(scaler.getFactor() == 1)
+          {
+            roi.pushSubimage(currentFrame);
+            virtualFencing.drawMaskOverlay(currentFrame);
+            virtualFencing.drawOverlayOnObjects(currentFrame);
+            roi.popSubimage(currentFrame);
+          }
+          else
+          {
+            for(unsigned int i = 0; i < virtualFencing.mTracksVF.size(); i++)
+              drawBbox(currentFrame, toFrame(analysis, virtualFencing.mTracksVF[i].mBbox), Vi::YCC_GREEN);
+          }
+        }
         
         // +++++++++++++++
         // +++ DISPLAY +++
@@ -147,49 +487,29 @@ int RbeVirtualFence::run()
         */
         ///dai code/// : Custom draw
         
-        for (unsigned int i = 0; i < virtualFencing.mTracksVF.size(); i++)
+        const std::vector<Rbe::Object *> &objects = engine->getObjects();
+        for (unsigned int i = 0; showFrame && !alerts.empty() && i < virtualFencing.mTracksVF.size(); i++)
         {          
-          Rbe::Object *object = engine->getObjects()[i];          
+          Rbe::Object *object = objects[i];          
           
           int objectID = -1;
           int contextID = -1;
           Rbe::Event *event = NULL;
-          for(int j = 0 ; j < engine->getRules().size(); j++)
+          const Rbe::Alert *alert = alerts.find(object->getId());
+          if(alert != NULL)
           {
-            Rbe::EventContainer *container = engine->getRules()[j]->getEventContainer();
-            for(int a = 0 ; a < container->mContainers.size(); a++)
-            {
-              this->loadSub(objectID,contextID,event, container->mContainers[a],object);
-            }
-            for(int k = 0 ; k < container->mResultQueue.size(); k++)
-            {
-              Rbe::QueueStruct *qT = &container->mResultQueue[k];
-              if(qT->result == true)
-              {
-                for(int l=0; l < qT->objectsID.size(); l++)
-                {
-                  int oID = qT->objectsID[l];
-                  if(object->getId() == oID)
-                  {
-                    objectID = oID;
-                    event = qT->eventSource;
-                    if(event->getType() == Rbe::Event::CROSSING_TRIPWIRE)
-                    {
-                      contextID = qT->contextID;
-                    }
-                  }
-                  
-                }
-              }
-            }
+            objectID = alert->objectId;
+            event = alert->event;
+            contextID = alert->contextId;
           }
           
           if(objectID != -1)
           {          
-            drawBbox(currentFrame, virtualFencing.mTracksVF[i].mBbox, Vi::YCC_RED);
+            Vi::Bbox<int> bbox = toFrame(analysis, virtualFencing.mTracksVF[i].mBbox);
+            drawBbox(currentFrame, bbox, Vi::YCC_RED);
             if(event != NULL)
             {
-              markupFont.drawText(currentFrame, event->getTypeString() , virtualFencing.mTracksVF[i].mBbox.p1, Vi::YCC_RED);   
+              markupFont.drawText(currentFrame, event->getTypeString() , bbox.p1, Vi::YCC_RED);   
               
               if(event->getTypeString() == "CROSSING_TRIPWIRE")
                 virtualFencing.drawRbeTripwire2(currentFrame, Vi::YCC_RED,contextID);
@@ -204,8 +524,42 @@ int RbeVirtualFence::run()
         }
         
         ///dai code/// : draw trajectory
-        unsigned length = 10;
-        virtualFencing.drawObjectsTrajectories(currentFrame,length,Vi::YCC_YELLOW);
+        if(outputMode == OUTPUT_FULL && !shedFrame)
+        {
+          unsigned length = 10;
+          if(scaler.getFactor() == 1)
+          {
+            roi.pushSubimage(currentFrame);
+            virtualFencing.drawObjectsTrajectories(currentFrame,length,Vi::YCC_YELLOW);
+            roi.popSubimage(currentFrame);
+          }
+          else
+          {
+            for(unsigned int i = 0; i < objects.size(); i++)
+              drawTrajectory(currentFrame, analysis, objects[i]->getTrajectory(), length, Vi::YCC_YELLOW);
+          }
+        }
+        overlayTrace.end();
+        
+        // the GUI takes the results when it paints, a preview is only made
+        // when the previous one was taken
+        if(mPreviewQueue != NULL)
+        {
+          if(!alerts.empty())
+          {
+            RbeAlertSummary summary;
+            summary.frameNumber = frameCounter;
+            for(Rbe::AlertIndex::const_iterator it = alerts.begin(); it != alerts.end(); ++it)
+            {
+              std::string type = it->event != NULL ? it->event->getTypeString() : "ALERT";
+              summary.alerts << QString("%1 object %2").arg(QString::fromStdString(type)).arg(it->objectId);
+            }
+            mPreviewQueue->postAlerts(summary);
+          }
+          
+          if(mPreviewQueue->wantsFrame())
+            mPreviewQueue->postFrame(makePreview(currentFrame, PREVIEW_WIDTH), frameCounter);
+        }
         
         ///dai code/// :disable cout the timer        
         /*
@@ -215,63 +569,73 @@ int RbeVirtualFence::run()
         //clean the eventQueue
         engine->cleanRuleEventResultQueue();
         
+        if(showFrame)
+          shownFrame = frame;
+        
         frameCounter++;
+        
+        if(statsEnable && statsDumpInterval > 0 && frameCounter % statsDumpInterval == 0)
+        {
+          dumpEngineStats(engine, statsFileName);
+          if(shedEnable)
+            loadShedder.dumpText(std::cout);
+          if(outputFile.isOpen())
+            outputFile.dumpText(std::cout);
+        }
       }
       
-      // create markup display
-      currentFrameMarkup.subcopy(currentFrame, 0, 0);
-      vidDisplay.write(currentFrameMarkup);
+      // a paused display keeps showing the last frame
+      if(vidDisplay && shownFrame && (showFrame || paused))
+      {
+        Rbe::ScopedTrace displayTrace("display", traceFrame);
+        vidDisplay->write(shownFrame->image);
+        displayTrace.end();
+      }
       
       ///dai code/// : disable clone video
       
       // write to video file
-      outputFile.write(currentFrameMarkup);
+      if(showFrame && shownFrame && outputFile.isOpen())
+      {
+        Rbe::ScopedTrace writeTrace("AsyncFrameWriter::write", traceFrame);
+        outputFile.write(shownFrame);
+        writeTrace.end();
+      }
+      
+      if(processFrame)
+        loadShedder.processed(Rbe::EngineStats::now() / 1e9 - frameStart);
       
     }
     
     ///dai code/// : disable clone video
     
-    // close output video file
-    outputFile.close();    
+    // close output video file, after the queued frames are written
+    if(outputFile.isOpen())
+    {
+      outputFile.close();
+      outputFile.dumpText(std::cout);
+    }
+    trackLog.close();
+    clipRecorder.close();
+    
+    if(statsEnable)
+      dumpEngineStats(engine, statsFileName);
+    if(shedEnable)
+      loadShedder.dumpText(std::cout);
+    
+    if(traceEnable)
+      Rbe::Trace::flush(traceFileName);
+    Rbe::Trace::setEnabled(false);
+    Rbe::Trace::endThread();
     
   }
   catch (const std::exception &e)
   {
+    Rbe::Trace::setEnabled(false);
+    Rbe::Trace::endThread();
     std::cout << "Error: " << e.what() << std::endl;
     return EXIT_FAILURE;
   }
   return EXIT_SUCCESS;
 }
 
-void RbeVirtualFence::loadSub(int &objectID,int &contextID, Rbe::Event *event,Rbe::EventContainer *container,Rbe::Object *object)
-{
-  for(int b = 0 ; b < container->mContainers.size(); b++)
-  {
-    this->loadSub(objectID,contextID,event, container->mContainers[b],object);
-  }
-  
-  for(int k = 0 ; k < container->mResultQueue.size(); k++)
-  { 
-    Rbe::QueueStruct *qT = &container->mResultQueue[k];
-    if(qT->result == true)
-    {
-      for(int l=0; l < qT->objectsID.size(); l++)
-      {
-        int oID = qT->objectsID[l];
-        if(object->getId() == oID)
-        {
-          objectID = oID;
-          event = qT->eventSource;
-          if(event != NULL)
-          {
-            if(event->getType() == Rbe::Event::CROSSING_TRIPWIRE)
-            {
-              contextID = qT->contextID;
-            }
-          }
-        }
-        
-      }
-    }
-  }
-}
@@ -4,8 +4,11 @@
 #include <QDialog>
 #include <QString>
 #include <QMessageBox>
+#include <QAtomicInt>
 #include "MainWindow.hpp"
 
+class RbePreviewQueue;
+
 namespace Rbe{
     class Engine;
     class Rule;
@@ -22,13 +25,22 @@ public:
     
   int run();
   
+  /// post alert summaries and preview frames to queue while running (NULL: none).
+  void setPreviewQueue(RbePreviewQueue *queue){mPreviewQueue = queue;}
+  
+  /// make run() return after the current frame, may be called from any thread.
+  void requestStop(){mStopRequested = 1;}
+  
   MainWindow *mainW;
   Rbe::Engine *engine;
   QString videoFilePath;
   QString tempContextPath;
   QString tempRulePath;
   
-  void loadSub(int &oID,int &cID, Rbe::Event *event, Rbe::EventContainer *c, Rbe::Object *);
+private:
+  RbePreviewQueue *mPreviewQueue;
+  QAtomicInt mStopRequested;
+  
 signals:
 
 public slots:
@@ -0,0 +1,20 @@
+#include "RbeVirtualFenceThread.hpp"
+
+#include "RbeVirtualFence.hpp"
+
+RbeVirtualFenceThread::RbeVirtualFenceThread(RbeVirtualFence *fence, QObject *parent) :
+  QThread(parent)
+{
+  mFence = fence;
+  mResult = 0;
+}
+
+void RbeVirtualFenceThread::stop()
+{
+  mFence->requestStop();
+}
+
+void RbeVirtualFenceThread::run()
+{
+  mResult = mFence->run();
+}
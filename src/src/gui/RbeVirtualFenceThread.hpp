@@ -0,0 +1,34 @@
+#ifndef RBEVIRTUALFENCETHREAD_HPP
+#define RBEVIRTUALFENCETHREAD_HPP
+
+#include <QThread>
+
+class RbeVirtualFence;
+
+/**
+  * Runs RbeVirtualFence::run() off the GUI thread. The results reach the
+  * GUI through the RbePreviewQueue of the fence; finished() is emitted when
+  * the video is done or stop() was called.
+  */
+class RbeVirtualFenceThread : public QThread
+{
+  Q_OBJECT
+public:
+  /// the thread does not own the fence, it must outlive the thread.
+  RbeVirtualFenceThread(RbeVirtualFence *fence, QObject *parent = 0);
+
+  /// ask the fence to stop after the current frame.
+  void stop();
+
+  /// return value of RbeVirtualFence::run().
+  int getResult() const {return mResult;}
+
+protected:
+  void run();
+
+private:
+  RbeVirtualFence *mFence;
+  int mResult;
+};
+
+#endif // RBEVIRTUALFENCETHREAD_HPP
@@ -1,5 +1,7 @@
 #include "RbeVisualizeWidget_GraphicsScene.hpp"
 
+#include <QPainter>
+
 #include "RbeVisualizeWidget_LineItem.hpp"
 #include "RbeVisualizeWidget_PolygonItem.hpp"
 #include "RbeGeneralContainer.hpp"
@@ -310,3 +312,34 @@ void RbeVisualizeWidget_GraphicsScene::drawBackground ( QPainter * painter, cons
 {
   QGraphicsScene::drawBackground(painter,rect);
 }
+
+void RbeVisualizeWidget_GraphicsScene::setOverlay(const QList<RbeOverlayBox> &overlay)
+{
+  if(overlay.isEmpty() && mOverlay.isEmpty())
+    return;
+  
+  mOverlay = overlay;
+  update();
+}
+
+void RbeVisualizeWidget_GraphicsScene::drawForeground ( QPainter * painter, const QRectF & rect )
+{
+  QGraphicsScene::drawForeground(painter,rect);
+  
+  // drawn at display time, the video itself is never touched
+  painter->save();
+  for(int i = 0; i < mOverlay.size(); i++)
+  {
+    const RbeOverlayBox &overlay = mOverlay.at(i);
+    if(!rect.intersects(QRectF(overlay.box.adjusted(-1, -16, 1, 1))))
+      continue;
+    
+    QPen pen(overlay.alert ? Qt::red : Qt::green);
+    pen.setCosmetic(true);
+    painter->setPen(pen);
+    painter->drawRect(overlay.box);
+    painter->drawEllipse(overlay.point, 2, 2);
+    painter->drawText(overlay.box.topLeft() - QPoint(0, 3), overlay.label);
+  }
+  painter->restore();
+}
@@ -11,6 +11,15 @@ class RbeVisualizeWidget_LineItem;
 class RbeVisualizeWidget_PolygonItem;
 class RbeGeneralContainer;
 
+/// a detection drawn over the video, in frame pixels.
+struct RbeOverlayBox
+{
+  QRect box;
+  QPoint point;   ///< newest trajectory point.
+  QString label;
+  bool alert;     ///< the object raised an alert in the frame.
+};
+
 class RbeVisualizeWidget_GraphicsScene : public QGraphicsScene
 {
     Q_OBJECT
@@ -60,6 +69,9 @@ public:
     
     void clearAllItems();
     
+    /// detections drawn over the video and the contexts, an empty list removes them.
+    void setOverlay(const QList<RbeOverlayBox> &overlay);
+    
 protected:
     void contextMenuEvent ( QGraphicsSceneContextMenuEvent * contextMenuEvent );
     
@@ -74,6 +86,7 @@ private:
     int mDeleteItemId;
     QPointF mScenePos;
     QHash<uint,QGraphicsItem *> mContextItems;    
+    QList<RbeOverlayBox> mOverlay;
        
     
 protected:
@@ -81,6 +94,7 @@ protected:
     void mouseMoveEvent(QGraphicsSceneMouseEvent *mouseEvent);
     void mouseReleaseEvent(QGraphicsSceneMouseEvent *mouseEvent);
     void drawBackground ( QPainter * painter, const QRectF & rect );
+    void drawForeground ( QPainter * painter, const QRectF & rect );
    
 public slots:
     void setMode(int mode);
@@ -148,6 +148,122 @@ void writeDefautlVirtualFecingIni(QTextStream &stream)
   stream << "Recording_bitRate = 5000000\n";
   stream << "Recording_bitRate = uint32_t\n";
 
+  stream << "; record a clip around every frame with an alert, from a ring of encoded frames (the clips are taken before the overlay is drawn; result.avi is then not written)\n";
+  stream << "Recording_clipEnable = false\n";
+  stream << "Recording_clipEnable = bool\n";
+
+  stream << "; clips are written to <prefix><frame number>.avi\n";
+  stream << "Recording_clipPrefix = ./data/.temp/VirtualFence/clip_\n";
+  stream << "Recording_clipPrefix = string\n";
+
+  stream << "[RuleBasedEngineStats]\n";
+
+  stream << "; record per rule, container and event evaluation statistics\n";
+  stream << "Stats_enable = false\n";
+  stream << "Stats_enable = bool\n";
+
+  stream << "; dump the statistics every n processed frames (0 = only at the end)\n";
+  stream << "Stats_dumpIntervalFrames = 250\n";
+  stream << "Stats_dumpIntervalFrames = uint32_t\n";
+
+  stream << "; name of the JSON file the statistics are written to\n";
+  stream << "Stats_dumpFileName = ./data/.temp/VirtualFence/stats.json\n";
+  stream << "Stats_dumpFileName = string\n";
+
+  stream << "[RuleBasedEngineTrace]\n";
+
+  stream << "; record the begin and end time of every processing stage per frame\n";
+  stream << "Trace_enable = false\n";
+  stream << "Trace_enable = bool\n";
+
+  stream << "; number of stages kept in memory per thread, older stages are overwritten\n";
+  stream << "Trace_bufferSize = 65536\n";
+  stream << "Trace_bufferSize = uint32_t\n";
+
+  stream << "; name of the Chrome trace-event JSON file, written on pause and at the end\n";
+  stream << "Trace_fileName = ./data/.temp/VirtualFence/trace.json\n";
+  stream << "Trace_fileName = string\n";
+
+  stream << "[TrackLog]\n";
+
+  stream << "; record the tracks and alerts per frame to a binary track log (replay with rbe-replay, show over the video in the editor)\n";
+  stream << "TrackLog_enable = false\n";
+  stream << "TrackLog_enable = bool\n";
+
+  stream << "; name of the track log, the frame index is written next to it (.idx)\n";
+  stream << "TrackLog_fileName = ./data/.temp/VirtualFence/tracks.rbt\n";
+  stream << "TrackLog_fileName = string\n";
+
+  stream << "[Output]\n";
+
+  stream << "; none: only run the rules (with TrackLog_enable the editor draws the results over the original video), alerts: draw, show and write only the frames with an alert, full: everything\n";
+  stream << "Output_mode = full\n";
+  stream << "Output_mode = string\n";
+
+  stream << "; the bit rate of the result video\n";
+  stream << "Output_bitRate = 5000000\n";
+  stream << "Output_bitRate = uint32_t\n";
+
+  stream << "; the result video is encoded in its own thread, frames queued at most\n";
+  stream << "Output_maxQueuedFrames = 8\n";
+  stream << "Output_maxQueuedFrames = uint32_t\n";
+
+  stream << "; drop frames of the result video when the queue is full, instead of waiting for the encoder\n";
+  stream << "Output_dropWhenFull = false\n";
+  stream << "Output_dropWhenFull = bool\n";
+
+  stream << "[ProcessingRoi]\n";
+
+  stream << "; track objects only in the bounding box of the contexts (the background model then covers only that box)\n";
+  stream << "Roi_enable = false\n";
+  stream << "Roi_enable = bool\n";
+
+  stream << "; pixels added around the contexts, objects are tracked this long before they reach one\n";
+  stream << "Roi_margin = 32\n";
+  stream << "Roi_margin = uint32_t\n";
+
+  stream << "[ProcessingScale]\n";
+
+  stream << "; track objects on frames downscaled by this factor (1 to 4), the rules stay in frame coordinates. The tracker settings stay in tracker pixels: divide the ContextFilter sizes and border offset and TOVF_minSpeedThreshold by the factor. The mask overlay is not drawn when scaled\n";
+  stream << "Scale_factor = 1\n";
+  stream << "Scale_factor = uint32_t\n";
+
+  stream << "[MotionGate]\n";
+
+  stream << "; skip the tracker and the rules on frames without motion (compared with the previous frame)\n";
+  stream << "Gate_enable = false\n";
+  stream << "Gate_enable = bool\n";
+
+  stream << "; compare one luma row in n\n";
+  stream << "Gate_rowStep = 4\n";
+  stream << "Gate_rowStep = uint32_t\n";
+
+  stream << "; mean absolute pixel difference that counts as motion\n";
+  stream << "Gate_threshold = 2.0\n";
+  stream << "Gate_threshold = float\n";
+
+  stream << "; number of frames without motion before the gate goes idle\n";
+  stream << "Gate_idleFrames = 50\n";
+  stream << "Gate_idleFrames = uint32_t\n";
+
+  stream << "; while idle, process one frame in n to keep the background model current\n";
+  stream << "Gate_idleInterval = 25\n";
+  stream << "Gate_idleInterval = uint32_t\n";
+
+  stream << "[LoadShedding]\n";
+
+  stream << "; skip the analysis of frames when the processing falls behind the input\n";
+  stream << "Shed_enable = false\n";
+  stream << "Shed_enable = bool\n";
+
+  stream << "; lag behind the input time allowed before frames are skipped, in milliseconds\n";
+  stream << "Shed_latencyBudgetMs = 200\n";
+  stream << "Shed_latencyBudgetMs = uint32_t\n";
+
+  stream << "; number of frames skipped in a row at most\n";
+  stream << "Shed_maxConsecutiveSkips = 10\n";
+  stream << "Shed_maxConsecutiveSkips = uint32_t\n";
+
   stream << "[IoBox]\n";
 
   stream << "; IP adress of the IObox\n";
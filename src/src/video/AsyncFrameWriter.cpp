@@ -0,0 +1,150 @@
+#include "AsyncFrameWriter.hpp"
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
+#include "src/core/EngineStats.hpp"
+
+using namespace Rbe;
+
+AsyncFrameWriter::AsyncFrameWriter()
+{
+  mOpen = false;
+  mMaxQueued = 1;
+  mDropWhenFull = false;
+  mStop = false;
+
+  mQueued = 0;
+  mWritten = 0;
+  mDropped = 0;
+  mMaxDepth = 0;
+  mWaitTime = 0;
+}
+
+AsyncFrameWriter::~AsyncFrameWriter()
+{
+  close();
+}
+
+void AsyncFrameWriter::open(unsigned width, unsigned height, const std::string &fileName, Vi::Frac<> fps,
+                            unsigned bitRate, unsigned maxQueued, bool dropWhenFull)
+{
+  close();
+
+  // the frames are buffered here, as handles; the queue of the output
+  // copies every frame, so it is kept short
+  mOutput.setQueueSize(2);
+  mOutput.open(width, height, fileName, fps, bitRate);
+
+  mMaxQueued = std::max(1u, maxQueued);
+  mDropWhenFull = dropWhenFull;
+  mStop = false;
+  mQueued = 0;
+  mWritten = 0;
+  mDropped = 0;
+  mMaxDepth = 0;
+  mWaitTime = 0;
+
+  mThread = boost::thread(boost::bind(&AsyncFrameWriter::run, this));
+  mOpen = true;
+}
+
+void AsyncFrameWriter::close()
+{
+  if(!mOpen)
+    return;
+
+  {
+    boost::mutex::scoped_lock lock(mMutex);
+    mStop = true;
+    mNotEmpty.notify_all();
+  }
+  mThread.join();
+
+  mOutput.close();
+  mOpen = false;
+}
+
+bool AsyncFrameWriter::write(const FrameHandle &frame)
+{
+  boost::mutex::scoped_lock lock(mMutex);
+  if(mQueue.size() >= mMaxQueued)
+  {
+    if(mDropWhenFull)
+    {
+      mDropped++;
+      return false;
+    }
+
+    uint64_t start = EngineStats::now();
+    while(mQueue.size() >= mMaxQueued)
+      mNotFull.wait(lock);
+    mWaitTime += (EngineStats::now() - start) / 1e9;
+  }
+
+  mQueue.push_back(frame);
+  mQueued++;
+  mMaxDepth = std::max(mMaxDepth, (unsigned)mQueue.size());
+  mNotEmpty.notify_one();
+  return true;
+}
+
+void AsyncFrameWriter::run()
+{
+  boost::mutex::scoped_lock lock(mMutex);
+  for(;;)
+  {
+    while(mQueue.empty() && !mStop)
+      mNotEmpty.wait(lock);
+    // the queued frames are written before stopping
+    if(mQueue.empty())
+      return;
+
+    FrameHandle frame = mQueue.front();
+    mQueue.pop_front();
+    mNotFull.notify_one();
+
+    lock.unlock();
+    mOutput.write(frame->image);
+    // back to the pool before waiting for the next one
+    frame.reset();
+    lock.lock();
+
+    mWritten++;
+  }
+}
+
+uint64_t AsyncFrameWriter::getNbQueued() const
+{
+  boost::mutex::scoped_lock lock(mMutex);
+  return mQueued;
+}
+
+uint64_t AsyncFrameWriter::getNbWritten() const
+{
+  boost::mutex::scoped_lock lock(mMutex);
+  return mWritten;
+}
+
+uint64_t AsyncFrameWriter::getNbDropped() const
+{
+  boost::mutex::scoped_lock lock(mMutex);
+  return mDropped;
+}
+
+double AsyncFrameWriter::getWaitTime() const
+{
+  boost::mutex::scoped_lock lock(mMutex);
+  return mWaitTime;
+}
+
+void AsyncFrameWriter::dumpText(std::ostream &out) const
+{
+  boost::mutex::scoped_lock lock(mMutex);
+  out << "frame writer: queued " << mQueued
+      << " written " << mWritten
+      << " dropped " << mDropped
+      << " deepest queue " << mMaxDepth
+      << " waited " << mWaitTime * 1000 << " ms" << std::endl;
+}
@@ -0,0 +1,93 @@
+/** \file
+  * The AsyncFrameWriter class file. Writes pool frames to a video file from
+  * its own thread.
+  *
+  * $Id$
+  */
+
+#ifndef ASYNCFRAMEWRITER_HPP
+#define ASYNCFRAMEWRITER_HPP
+
+#include <deque>
+#include <ostream>
+#include <string>
+#include <stdint.h>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <ViNotion/VideoOutputVideoFile.hpp>
+
+#include "FramePool.hpp"
+
+namespace Rbe
+{
+  /**
+    * write() only queues a handle to the frame; the copy, the colour
+    * conversion and the encoding of Vi::VideoOutputVideoFile run on the
+    * writer thread. The queue holds at most maxQueued frames; when it is
+    * full write() waits for room (backpressure), or drops the frame when
+    * dropWhenFull is set. The frames must not be changed once written.
+    */
+  class AsyncFrameWriter
+  {
+  public:
+    AsyncFrameWriter();
+    ~AsyncFrameWriter();
+
+    /**
+      * Open the video file and start the writer thread.
+      *
+      * \param[in] width width of the frames.
+      * \param[in] height height of the frames.
+      * \param[in] fileName the video file.
+      * \param[in] fps frame rate of the video.
+      * \param[in] bitRate bit rate of the video.
+      * \param[in] maxQueued frames queued at most.
+      * \param[in] dropWhenFull drop frames instead of waiting when the queue is full.
+      */
+    void open(unsigned width, unsigned height, const std::string &fileName, Vi::Frac<> fps,
+              unsigned bitRate, unsigned maxQueued, bool dropWhenFull);
+
+    /// write the queued frames, stop the thread and close the file.
+    void close();
+
+    inline bool isOpen() const {return mOpen;}
+
+    /// queue a frame, false if it was dropped.
+    bool write(const FrameHandle &frame);
+
+    uint64_t getNbQueued() const;
+    uint64_t getNbWritten() const;
+    uint64_t getNbDropped() const;
+    /// time write() spent waiting for room in the queue, in seconds.
+    double getWaitTime() const;
+
+    /// write the counters as one line of text.
+    void dumpText(std::ostream &out) const;
+
+  private:
+    void run();
+
+    Vi::VideoOutputVideoFile mOutput;
+    boost::thread mThread;
+    bool mOpen;
+
+    mutable boost::mutex mMutex;  ///< guards the members below.
+    boost::condition_variable mNotEmpty;
+    boost::condition_variable mNotFull;
+    std::deque<FrameHandle> mQueue;
+    unsigned mMaxQueued;
+    bool mDropWhenFull;
+    bool mStop;
+
+    uint64_t mQueued;
+    uint64_t mWritten;
+    uint64_t mDropped;
+    unsigned mMaxDepth;     ///< deepest the queue has been.
+    double mWaitTime;
+  };
+}
+
+#endif // ASYNCFRAMEWRITER_HPP
@@ -0,0 +1,288 @@
+#include "ClipRecorder.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <cstring>
+
+#include "extra/QTFFmpegWrapper/ffmpeg.h"
+
+using namespace Rbe;
+
+ClipRecorder::ClipRecorder()
+{
+  mCodecCtx = NULL;
+  mPicture = NULL;
+  mClipCtx = NULL;
+  mClipStream = NULL;
+  mClipStartPts = 0;
+  mFailed = false;
+  mRingBytes = 0;
+  mFps = 25;
+  mPreFrames = 0;
+  mPostFrames = 0;
+  mPostLeft = 0;
+  mPts = 0;
+}
+
+ClipRecorder::~ClipRecorder()
+{
+  close();
+}
+
+bool ClipRecorder::open(unsigned width, unsigned height, unsigned fps, unsigned bitRate,
+                        unsigned secondsAroundEvent, const std::string &filePrefix)
+{
+  close();
+
+  ffmpeg::avcodec_init();
+  ffmpeg::av_register_all();
+
+  ffmpeg::AVCodec *codec = ffmpeg::avcodec_find_encoder(ffmpeg::CODEC_ID_MPEG4);
+  if(codec == NULL || width % 2 != 0 || height % 2 != 0 || fps == 0)
+    return false;
+
+  mCodecCtx = ffmpeg::avcodec_alloc_context();
+  mCodecCtx->codec_type = ffmpeg::CODEC_TYPE_VIDEO;
+  mCodecCtx->codec_id = ffmpeg::CODEC_ID_MPEG4;
+  mCodecCtx->bit_rate = bitRate;
+  mCodecCtx->width = width;
+  mCodecCtx->height = height;
+  mCodecCtx->time_base.num = 1;
+  mCodecCtx->time_base.den = fps;
+  mCodecCtx->gop_size = fps;        // a key frame every second, the ring starts at one
+  mCodecCtx->max_b_frames = 0;      // one packet per frame, in frame order
+  mCodecCtx->pix_fmt = ffmpeg::PIX_FMT_YUV420P;
+
+  if(ffmpeg::avcodec_open(mCodecCtx, codec) < 0)
+  {
+    ffmpeg::av_free(mCodecCtx);
+    mCodecCtx = NULL;
+    return false;
+  }
+
+  mPicture = ffmpeg::avcodec_alloc_frame();
+  mPictureBuf.resize(ffmpeg::avpicture_get_size(ffmpeg::PIX_FMT_YUV420P, width, height));
+  ffmpeg::avpicture_fill((ffmpeg::AVPicture *)mPicture, &mPictureBuf[0], ffmpeg::PIX_FMT_YUV420P, width, height);
+
+  // generous, an encoded frame is far smaller than the raw frame
+  mOutBuf.resize(width * height * 3 / 2 + 10000);
+
+  mFps = fps;
+  mPreFrames = secondsAroundEvent * fps;
+  mPostFrames = secondsAroundEvent * fps;
+  mPostLeft = 0;
+  mPts = 0;
+  mFailed = false;
+  mFilePrefix = filePrefix;
+
+  return true;
+}
+
+void ClipRecorder::close()
+{
+  endClip();
+
+  if(mCodecCtx != NULL)
+  {
+    ffmpeg::avcodec_close(mCodecCtx);
+    ffmpeg::av_free(mCodecCtx);
+    mCodecCtx = NULL;
+  }
+  if(mPicture != NULL)
+  {
+    ffmpeg::av_free(mPicture);
+    mPicture = NULL;
+  }
+
+  mRing.clear();
+  mFreeBuffers.clear();
+  mRingBytes = 0;
+}
+
+void ClipRecorder::write(const Vi::Image<> &frame, uint64_t frameNumber, bool event)
+{
+  if(!isOpen())
+    return;
+
+  convert(frame);
+  mPicture->pts = mPts;
+
+  int size = ffmpeg::avcodec_encode_video(mCodecCtx, &mOutBuf[0], mOutBuf.size(), mPicture);
+  bool encoded = size > 0;
+  if(encoded)
+    push(&mOutBuf[0], size, mPts, mCodecCtx->coded_frame->key_frame != 0);
+  mPts++;
+
+  if(event)
+  {
+    // a new clip gets the whole ring, the current frame included
+    if(!isRecording())
+    {
+      if(!mFailed)
+        mFailed = !startClip(frameNumber);
+    }
+    else if(encoded)
+      writeClip(mRing.back());
+    mPostLeft = mPostFrames;
+  }
+  else if(isRecording())
+  {
+    if(encoded)
+      writeClip(mRing.back());
+    if(mPostLeft == 0 || --mPostLeft == 0)
+      endClip();
+  }
+}
+
+void ClipRecorder::convert(const Vi::Image<> &frame)
+{
+  unsigned width = mCodecCtx->width;
+  unsigned height = mCodecCtx->height;
+
+  // Y is copied, Cb and Cr are averaged over 2x2 pixels
+  for(unsigned y = 0; y < height; y++)
+    memcpy(mPicture->data[0] + y * mPicture->linesize[0], frame.Y(y), width);
+
+  for(unsigned y = 0; y < height / 2; y++)
+  {
+    const uint8_t *cb0 = frame.Cb(2 * y);
+    const uint8_t *cb1 = frame.Cb(2 * y + 1);
+    const uint8_t *cr0 = frame.Cr(2 * y);
+    const uint8_t *cr1 = frame.Cr(2 * y + 1);
+    uint8_t *u = mPicture->data[1] + y * mPicture->linesize[1];
+    uint8_t *v = mPicture->data[2] + y * mPicture->linesize[2];
+
+    for(unsigned x = 0; x < width / 2; x++)
+    {
+      u[x] = (cb0[2 * x] + cb0[2 * x + 1] + cb1[2 * x] + cb1[2 * x + 1] + 2) >> 2;
+      v[x] = (cr0[2 * x] + cr0[2 * x + 1] + cr1[2 * x] + cr1[2 * x + 1] + 2) >> 2;
+    }
+  }
+}
+
+void ClipRecorder::push(const uint8_t *data, unsigned size, int64_t pts, bool key)
+{
+  mRing.push_back(Packet());
+  Packet &packet = mRing.back();
+
+  // reuse the buffer of a dropped packet
+  if(!mFreeBuffers.empty())
+  {
+    packet.data.swap(mFreeBuffers.back());
+    mFreeBuffers.pop_back();
+  }
+  packet.data.assign(data, data + size);
+  packet.pts = pts;
+  packet.key = key;
+  mRingBytes += size;
+
+  trim();
+}
+
+void ClipRecorder::trim()
+{
+  // drop a whole group of pictures at a time, as long as the frames after it cover the pre-event window
+  while(mRing.size() > mPreFrames)
+  {
+    unsigned next = 1;
+    while(next < mRing.size() && !mRing[next].key)
+      next++;
+    if(next == mRing.size() || mRing.size() - next < mPreFrames)
+      break;
+
+    for(unsigned i = 0; i < next; i++)
+    {
+      mRingBytes -= mRing.front().data.size();
+      mFreeBuffers.push_back(std::vector<uint8_t>());
+      mFreeBuffers.back().swap(mRing.front().data);
+      mRing.pop_front();
+    }
+  }
+}
+
+bool ClipRecorder::startClip(uint64_t frameNumber)
+{
+  std::ostringstream name;
+  name << mFilePrefix << frameNumber << ".avi";
+  std::string fileName = name.str();
+
+  ffmpeg::AVOutputFormat *format = ffmpeg::guess_format("avi", NULL, NULL);
+  mClipCtx = ffmpeg::avformat_alloc_context();
+  if(format == NULL || mClipCtx == NULL)
+  {
+    std::cout << "Error: cannot create clip " << fileName << ", no more clips are recorded" << std::endl;
+    if(mClipCtx != NULL)
+      ffmpeg::av_free(mClipCtx);
+    mClipCtx = NULL;
+    return false;
+  }
+  mClipCtx->oformat = format;
+  snprintf(mClipCtx->filename, sizeof(mClipCtx->filename), "%s", fileName.c_str());
+
+  // the stream copies the encoder settings, the packets are written as they are
+  mClipStream = ffmpeg::av_new_stream(mClipCtx, 0);
+  ffmpeg::AVCodecContext *codec = mClipStream->codec;
+  codec->codec_type = ffmpeg::CODEC_TYPE_VIDEO;
+  codec->codec_id = mCodecCtx->codec_id;
+  codec->bit_rate = mCodecCtx->bit_rate;
+  codec->width = mCodecCtx->width;
+  codec->height = mCodecCtx->height;
+  codec->time_base = mCodecCtx->time_base;
+  codec->gop_size = mCodecCtx->gop_size;
+  codec->pix_fmt = mCodecCtx->pix_fmt;
+
+  if(ffmpeg::av_set_parameters(mClipCtx, NULL) < 0 ||
+     ffmpeg::url_fopen(&mClipCtx->pb, fileName.c_str(), URL_WRONLY) < 0)
+  {
+    std::cout << "Error: cannot create clip " << fileName << ", no more clips are recorded" << std::endl;
+    for(unsigned i = 0; i < mClipCtx->nb_streams; i++)
+    {
+      ffmpeg::av_freep(&mClipCtx->streams[i]->codec);
+      ffmpeg::av_freep(&mClipCtx->streams[i]);
+    }
+    ffmpeg::av_free(mClipCtx);
+    mClipCtx = NULL;
+    return false;
+  }
+  ffmpeg::av_write_header(mClipCtx);
+
+  mClipStartPts = mRing.empty() ? mPts : mRing.front().pts;
+  for(unsigned i = 0; i < mRing.size(); i++)
+    writeClip(mRing[i]);
+
+  return true;
+}
+
+void ClipRecorder::writeClip(const Packet &packet)
+{
+  ffmpeg::AVPacket pkt;
+  ffmpeg::av_init_packet(&pkt);
+  pkt.stream_index = mClipStream->index;
+  pkt.data = (uint8_t *)&packet.data[0];
+  pkt.size = packet.data.size();
+  pkt.pts = ffmpeg::av_rescale_q(packet.pts - mClipStartPts, mCodecCtx->time_base, mClipStream->time_base);
+  pkt.dts = pkt.pts;
+  if(packet.key)
+    pkt.flags |= PKT_FLAG_KEY;
+
+  ffmpeg::av_interleaved_write_frame(mClipCtx, &pkt);
+}
+
+void ClipRecorder::endClip()
+{
+  if(mClipCtx == NULL)
+    return;
+
+  ffmpeg::av_write_trailer(mClipCtx);
+  for(unsigned i = 0; i < mClipCtx->nb_streams; i++)
+  {
+    ffmpeg::av_freep(&mClipCtx->streams[i]->codec);
+    ffmpeg::av_freep(&mClipCtx->streams[i]);
+  }
+  ffmpeg::url_fclose(mClipCtx->pb);
+  ffmpeg::av_free(mClipCtx);
+
+  mClipCtx = NULL;
+  mClipStream = NULL;
+  mPostLeft = 0;
+}
@@ -0,0 +1,122 @@
+/** \file
+  * The ClipRecorder class file. Records video clips around events from a
+  * ring buffer of encoded packets.
+  *
+  * $Id$
+  */
+
+#ifndef CLIPRECORDER_HPP
+#define CLIPRECORDER_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <stdint.h>
+
+#include <ViNotion/Image.hpp>
+
+namespace ffmpeg
+{
+  struct AVCodecContext;
+  struct AVFormatContext;
+  struct AVStream;
+  struct AVFrame;
+}
+
+namespace Rbe
+{
+  /**
+    * Every frame is encoded once, the packets of the last preFrames frames
+    * are kept in a ring. When an event fires the ring is written to a new
+    * clip file, followed by the packets of the next postFrames frames; an
+    * event during a clip extends it. Raw frames are never kept.
+    *
+    * The encoder puts a key frame every second, the ring always starts at a
+    * key frame, so it holds at most preFrames + fps packets.
+    *
+    * A clip file that cannot be created stops the clips until the next
+    * open(), instead of failing again on every frame with an event.
+    */
+  class ClipRecorder
+  {
+  public:
+    ClipRecorder();
+    ~ClipRecorder();
+
+    /**
+      * Open the encoder.
+      *
+      * \param[in] width width of the frames.
+      * \param[in] height height of the frames.
+      * \param[in] fps frame rate of the input.
+      * \param[in] bitRate bit rate of the clips.
+      * \param[in] secondsAroundEvent seconds recorded before and after an event.
+      * \param[in] filePrefix clips are written to "<filePrefix><frame>.avi".
+      * \return false if the encoder could not be opened.
+      */
+    bool open(unsigned width, unsigned height, unsigned fps, unsigned bitRate,
+              unsigned secondsAroundEvent, const std::string &filePrefix);
+
+    /// Finish the current clip and close the encoder.
+    void close();
+
+    inline bool isOpen() const {return mCodecCtx != NULL;}
+
+    /// true while a clip is being written.
+    inline bool isRecording() const {return mClipCtx != NULL;}
+
+    /// true once a clip could not be created.
+    inline bool hasFailed() const {return mFailed;}
+
+    /**
+      * Encode one frame into the ring, and into the clip while recording.
+      *
+      * \param[in] frame the frame, YCC 4:4:4 planar.
+      * \param[in] frameNumber number of the frame, used in the clip name.
+      * \param[in] event true if an event fired in this frame.
+      */
+    void write(const Vi::Image<> &frame, uint64_t frameNumber, bool event);
+
+    /// number of bytes of encoded video held in the ring.
+    inline uint64_t getRingBytes() const {return mRingBytes;}
+
+  private:
+    /// One encoded frame.
+    struct Packet
+    {
+      std::vector<uint8_t> data;
+      int64_t pts;
+      bool key;
+    };
+
+    void convert(const Vi::Image<> &frame);
+    void push(const uint8_t *data, unsigned size, int64_t pts, bool key);
+    void trim();
+    bool startClip(uint64_t frameNumber);
+    void writeClip(const Packet &packet);
+    void endClip();
+
+    ffmpeg::AVCodecContext *mCodecCtx;  ///< the encoder.
+    ffmpeg::AVFrame *mPicture;          ///< YUV 4:2:0 input of the encoder.
+    std::vector<uint8_t> mPictureBuf;
+    std::vector<uint8_t> mOutBuf;       ///< encoder output.
+
+    ffmpeg::AVFormatContext *mClipCtx;  ///< the open clip, NULL when not recording.
+    ffmpeg::AVStream *mClipStream;
+    int64_t mClipStartPts;              ///< pts of the first packet of the clip.
+    bool mFailed;                       ///< a clip could not be created, no new ones are started.
+
+    std::deque<Packet> mRing;
+    std::vector<std::vector<uint8_t> > mFreeBuffers;  ///< packet buffers for reuse.
+    uint64_t mRingBytes;
+
+    unsigned mFps;
+    unsigned mPreFrames;
+    unsigned mPostFrames;
+    unsigned mPostLeft;                 ///< frames left in the current clip.
+    int64_t mPts;
+    std::string mFilePrefix;
+  };
+}
+
+#endif // CLIPRECORDER_HPP
@@ -0,0 +1,127 @@
+#include "FramePool.hpp"
+
+#include <boost/thread/mutex.hpp>
+
+using namespace Rbe;
+
+namespace Rbe
+{
+  /// The part of a pool the frames in use refer to.
+  struct FramePoolState
+  {
+    FramePoolState() : nbFrames(0), closed(false) {}
+
+    boost::mutex mutex;
+    std::vector<Frame *> free;  ///< frames not in use.
+    unsigned nbFrames;
+    bool closed;                ///< the pool was deleted.
+  };
+}
+
+// =============
+// === Frame ===
+// =============
+
+Frame::Frame(const boost::shared_ptr<FramePoolState> &pool, Vi::PIXEL_FORMAT format)
+  : image(format), frameNumber(0), mPool(pool), mRefs(0)
+{
+}
+
+void Rbe::intrusive_ptr_add_ref(Frame *frame)
+{
+  frame->mRefs.fetch_add(1, boost::memory_order_relaxed);
+}
+
+void Rbe::intrusive_ptr_release(Frame *frame)
+{
+  if(frame->mRefs.fetch_sub(1, boost::memory_order_acq_rel) == 1)
+    FramePool::recycle(frame);
+}
+
+// =================
+// === FramePool ===
+// =================
+
+FramePool::FramePool(unsigned width, unsigned height, unsigned nbFrames, Vi::PIXEL_FORMAT format)
+  : mState(new FramePoolState())
+{
+  mWidth = width;
+  mHeight = height;
+  mFormat = format;
+
+  mState->free.reserve(nbFrames);
+  for(unsigned i = 0; i < nbFrames; i++)
+    mState->free.push_back(allocate());
+}
+
+FramePool::~FramePool()
+{
+  // the frames still in use are freed when they come back
+  std::vector<Frame *> free;
+  {
+    boost::mutex::scoped_lock lock(mState->mutex);
+    mState->closed = true;
+    free.swap(mState->free);
+  }
+
+  for(unsigned i = 0; i < free.size(); i++)
+    delete free[i];
+}
+
+FrameHandle FramePool::acquire()
+{
+  Frame *frame = NULL;
+  {
+    boost::mutex::scoped_lock lock(mState->mutex);
+    if(!mState->free.empty())
+    {
+      frame = mState->free.back();
+      mState->free.pop_back();
+    }
+  }
+
+  if(frame == NULL)
+    frame = allocate();
+
+  return FrameHandle(frame);
+}
+
+unsigned FramePool::getNbFrames() const
+{
+  boost::mutex::scoped_lock lock(mState->mutex);
+  return mState->nbFrames;
+}
+
+unsigned FramePool::getNbFree() const
+{
+  boost::mutex::scoped_lock lock(mState->mutex);
+  return mState->free.size();
+}
+
+Frame *FramePool::allocate()
+{
+  Frame *frame = new Frame(mState, mFormat);
+  frame->image.size(mWidth, mHeight);
+
+  boost::mutex::scoped_lock lock(mState->mutex);
+  mState->nbFrames++;
+  // keep recycle() free of allocations
+  mState->free.reserve(mState->nbFrames);
+  return frame;
+}
+
+void FramePool::recycle(Frame *frame)
+{
+  FramePoolState &state = *frame->mPool;
+  {
+    boost::mutex::scoped_lock lock(state.mutex);
+    if(!state.closed)
+    {
+      state.free.push_back(frame);
+      return;
+    }
+  }
+
+  // the pool is gone; the frame may hold the last reference to the state
+  delete frame;
+}
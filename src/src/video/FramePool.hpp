@@ -0,0 +1,95 @@
+/** \file
+  * The FramePool class file. Preallocated, reference counted Vi::Image
+  * buffers that are passed between the stages of the video pipeline.
+  *
+  * $Id$
+  */
+
+#ifndef FRAMEPOOL_HPP
+#define FRAMEPOOL_HPP
+
+#include <vector>
+#include <stdint.h>
+
+#include <boost/intrusive_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/atomic.hpp>
+
+#include <ViNotion/Image.hpp>
+
+namespace Rbe
+{
+  class FramePool;
+  struct FramePoolState;
+
+  /**
+    * A frame buffer of a FramePool. It goes back to its pool when the last
+    * FrameHandle to it is released.
+    */
+  class Frame
+  {
+  public:
+    Vi::Image<> image;     ///< the pixels.
+    uint64_t frameNumber;  ///< number of the frame in the input.
+
+  private:
+    friend class FramePool;
+    friend void intrusive_ptr_add_ref(Frame *frame);
+    friend void intrusive_ptr_release(Frame *frame);
+
+    Frame(const boost::shared_ptr<FramePoolState> &pool, Vi::PIXEL_FORMAT format);
+
+    boost::shared_ptr<FramePoolState> mPool;  ///< outlives the pool while the frame is in use.
+    boost::atomic<int> mRefs;
+  };
+
+  void intrusive_ptr_add_ref(Frame *frame);
+  void intrusive_ptr_release(Frame *frame);
+
+  /// Shared handle to a pool frame, copying it copies no pixels.
+  typedef boost::intrusive_ptr<Frame> FrameHandle;
+
+  /**
+    * Pool of equally sized frames. acquire() takes a free frame, or allocates
+    * one when all are in use, so after the first frames the pipeline does not
+    * allocate. Handles may be released from any thread, also after the pool
+    * was deleted: a frame that comes back to a deleted pool is freed.
+    */
+  class FramePool
+  {
+  public:
+    /**
+      * Constructor.
+      *
+      * \param[in] width width of the frames.
+      * \param[in] height height of the frames.
+      * \param[in] nbFrames number of frames allocated up front.
+      * \param[in] format pixel format of the frames.
+      */
+    FramePool(unsigned width, unsigned height, unsigned nbFrames, Vi::PIXEL_FORMAT format = Vi::PF_YCC444P);
+    ~FramePool();
+
+    /// A free frame, its content is that of its previous use.
+    FrameHandle acquire();
+
+    /// number of frames allocated by the pool.
+    unsigned getNbFrames() const;
+
+    /// number of frames not in use.
+    unsigned getNbFree() const;
+
+  private:
+    friend void intrusive_ptr_release(Frame *frame);
+
+    Frame *allocate();
+    static void recycle(Frame *frame);
+
+    unsigned mWidth;
+    unsigned mHeight;
+    Vi::PIXEL_FORMAT mFormat;
+
+    boost::shared_ptr<FramePoolState> mState;  ///< the free frames, shared with the frames.
+  };
+}
+
+#endif // FRAMEPOOL_HPP
@@ -0,0 +1,129 @@
+#include "FrameScaler.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace Rbe;
+
+namespace
+{
+  inline const uint8_t *row(const Vi::Image<> &img, unsigned plane, unsigned y)
+  {
+    return plane == 0 ? img.Y(y) : (plane == 1 ? img.Cb(y) : img.Cr(y));
+  }
+
+  inline uint8_t *row(Vi::Image<> &img, unsigned plane, unsigned y)
+  {
+    return plane == 0 ? img.Y(y) : (plane == 1 ? img.Cb(y) : img.Cr(y));
+  }
+
+  /// one output row of a 2x2 box, width output pixels.
+  void box2(const uint8_t *in0, const uint8_t *in1, uint8_t *out, unsigned width)
+  {
+    unsigned x = 0;
+#ifdef __SSE2__
+    const __m128i lowBytes = _mm_set1_epi16(0x00ff);
+    const __m128i two = _mm_set1_epi16(2);
+    for(; x + 16 <= width; x += 16)
+    {
+      __m128i a0 = _mm_loadu_si128((const __m128i *)(in0 + 2 * x));
+      __m128i a1 = _mm_loadu_si128((const __m128i *)(in0 + 2 * x + 16));
+      __m128i b0 = _mm_loadu_si128((const __m128i *)(in1 + 2 * x));
+      __m128i b1 = _mm_loadu_si128((const __m128i *)(in1 + 2 * x + 16));
+
+      // even + odd byte of every 16 bit lane, of both rows
+      __m128i s0 = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a0, lowBytes), _mm_srli_epi16(a0, 8)),
+                                 _mm_add_epi16(_mm_and_si128(b0, lowBytes), _mm_srli_epi16(b0, 8)));
+      __m128i s1 = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a1, lowBytes), _mm_srli_epi16(a1, 8)),
+                                 _mm_add_epi16(_mm_and_si128(b1, lowBytes), _mm_srli_epi16(b1, 8)));
+      s0 = _mm_srli_epi16(_mm_add_epi16(s0, two), 2);
+      s1 = _mm_srli_epi16(_mm_add_epi16(s1, two), 2);
+
+      _mm_storeu_si128((__m128i *)(out + x), _mm_packus_epi16(s0, s1));
+    }
+#endif
+    for(; x < width; x++)
+      out[x] = (in0[2 * x] + in0[2 * x + 1] + in1[2 * x] + in1[2 * x + 1] + 2) >> 2;
+  }
+
+  /// sum the columns of F blocks of sum into out, the division is by a constant.
+  template<unsigned F>
+    void boxColumns(const uint16_t *sum, uint8_t *out, unsigned width)
+  {
+    for(unsigned x = 0; x < width; x++)
+    {
+      unsigned total = 0;
+      for(unsigned i = 0; i < F; i++)
+        total += sum[F * x + i];
+      out[x] = (total + F * F / 2) / (F * F);
+    }
+  }
+}
+
+FrameScaler::FrameScaler()
+{
+  mFactor = 1;
+}
+
+void FrameScaler::setFactor(unsigned factor)
+{
+  if(factor < 1 || factor > 4)
+    throw std::invalid_argument("FrameScaler::setFactor --> factor must be 1 to 4");
+  mFactor = factor;
+}
+
+void FrameScaler::scale(const Vi::Image<> &in, Vi::Image<> &out)
+{
+  unsigned width = scaledSize(in.w());
+  unsigned height = scaledSize(in.h());
+  if(out.w() != width || out.h() != height)
+    out.size(width, height);
+  if(width == 0 || height == 0)
+    return;
+
+  for(unsigned plane = 0; plane < 3; plane++)
+    scalePlane(plane, in, out);
+}
+
+void FrameScaler::scalePlane(unsigned plane, const Vi::Image<> &in, Vi::Image<> &out)
+{
+  unsigned width = out.w();
+  unsigned height = out.h();
+
+  if(mFactor == 1)
+  {
+    for(unsigned y = 0; y < height; y++)
+      std::copy(row(in, plane, y), row(in, plane, y) + width, row(out, plane, y));
+    return;
+  }
+
+  if(mFactor == 2)
+  {
+    for(unsigned y = 0; y < height; y++)
+      box2(row(in, plane, 2 * y), row(in, plane, 2 * y + 1), row(out, plane, y), width);
+    return;
+  }
+
+  // add the rows of a block column wise, then the columns
+  unsigned inWidth = width * mFactor;
+  mSum.resize(inWidth);
+  for(unsigned y = 0; y < height; y++)
+  {
+    std::fill(mSum.begin(), mSum.end(), 0);
+    for(unsigned i = 0; i < mFactor; i++)
+    {
+      const uint8_t *src = row(in, plane, mFactor * y + i);
+      for(unsigned x = 0; x < inWidth; x++)
+        mSum[x] += src[x];
+    }
+
+    if(mFactor == 3)
+      boxColumns<3>(&mSum[0], row(out, plane, y), width);
+    else
+      boxColumns<4>(&mSum[0], row(out, plane, y), width);
+  }
+}
@@ -0,0 +1,52 @@
+/** \file
+  * The FrameScaler class file. Integer factor box downscaling of the frames
+  * the tracker runs on.
+  *
+  * $Id$
+  */
+
+#ifndef FRAMESCALER_HPP
+#define FRAMESCALER_HPP
+
+#include <vector>
+#include <stdint.h>
+
+#include <ViNotion/Image.hpp>
+
+namespace Rbe
+{
+  /**
+    * Downscales a YCC 4:4:4 planar image by 1, 2, 3 or 4 in both directions,
+    * every output pixel is the rounded mean of a factor x factor block. The
+    * factor 2 rows use SSE2 when the compiler targets it. Only the current
+    * subimage of the input is read, so a roi can be pushed on the frame
+    * instead of being copied first.
+    */
+  class FrameScaler
+  {
+  public:
+    FrameScaler();
+
+    /// set the factor, 1 to 4 (throws std::invalid_argument otherwise).
+    void setFactor(unsigned factor);
+    inline unsigned getFactor() const {return mFactor;}
+
+    /// size of the output for an input of the given size.
+    inline unsigned scaledSize(unsigned size) const {return size / mFactor;}
+
+    /**
+      * Scale in into out, out is sized on the first call and reused after
+      * that. Trailing rows and columns that do not fill a block are dropped.
+      */
+    void scale(const Vi::Image<> &in, Vi::Image<> &out);
+
+  private:
+    /// scale plane 0 (Y), 1 (Cb) or 2 (Cr).
+    void scalePlane(unsigned plane, const Vi::Image<> &in, Vi::Image<> &out);
+
+    unsigned mFactor;
+    std::vector<uint16_t> mSum;  ///< column sums of one output row.
+  };
+}
+
+#endif // FRAMESCALER_HPP
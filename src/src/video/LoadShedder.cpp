@@ -0,0 +1,69 @@
+#include "LoadShedder.hpp"
+
+using namespace Rbe;
+
+namespace
+{
+  /// weight of a new sample in the mean cost.
+  const double COST_WEIGHT = 0.1;
+}
+
+LoadShedder::LoadShedder()
+{
+  configure(0.2, 10);
+}
+
+void LoadShedder::configure(double latencyBudget, unsigned maxSkips)
+{
+  mBudget = latencyBudget;
+  mMaxSkips = maxSkips;
+
+  mStart = 0;
+  mMeanCost = 0;
+  mLag = 0;
+  mSkipRun = 0;
+
+  mFrames = 0;
+  mSkipped = 0;
+  mLongestSkipRun = 0;
+}
+
+void LoadShedder::rebase(double frameTime, double now)
+{
+  mStart = now - frameTime;
+}
+
+bool LoadShedder::shouldProcess(double frameTime, double now)
+{
+  mFrames++;
+  mLag = now - (mStart + frameTime);
+
+  if(mSkipRun < mMaxSkips && mLag + mMeanCost > mBudget)
+  {
+    mSkipped++;
+    mSkipRun++;
+    if(mSkipRun > mLongestSkipRun)
+      mLongestSkipRun = mSkipRun;
+    return false;
+  }
+
+  mSkipRun = 0;
+  return true;
+}
+
+void LoadShedder::processed(double cost)
+{
+  if(mMeanCost == 0)
+    mMeanCost = cost;
+  else
+    mMeanCost += COST_WEIGHT * (cost - mMeanCost);
+}
+
+void LoadShedder::dumpText(std::ostream &out) const
+{
+  out << "load shedding: frames " << mFrames
+      << " skipped " << mSkipped
+      << " longest skip run " << mLongestSkipRun
+      << " mean cost " << mMeanCost * 1000 << " ms"
+      << " lag " << mLag * 1000 << " ms" << std::endl;
+}
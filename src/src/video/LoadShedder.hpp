@@ -0,0 +1,75 @@
+/** \file
+  * The LoadShedder class file. Skips the analysis of frames when the video
+  * pipeline falls behind its input.
+  *
+  * $Id$
+  */
+
+#ifndef LOADSHEDDER_HPP
+#define LOADSHEDDER_HPP
+
+#include <ostream>
+#include <stdint.h>
+
+namespace Rbe
+{
+  /**
+    * Every frame is due at its input time (relative to the time the input
+    * started). A frame is skipped when its lag behind that time, plus the
+    * mean cost of a processed frame, exceeds the latency budget. At most
+    * maxSkips frames are skipped in a row, so the tracker keeps seeing the
+    * scene. Times are in seconds.
+    */
+  class LoadShedder
+  {
+  public:
+    LoadShedder();
+
+    /**
+      * Set the parameters and reset the counters.
+      *
+      * \param[in] latencyBudget lag allowed behind the input, in seconds.
+      * \param[in] maxSkips frames skipped in a row at most.
+      */
+    void configure(double latencyBudget, unsigned maxSkips);
+
+    /// make the frame at frameTime due at now (at the start and after a pause).
+    void rebase(double frameTime, double now);
+
+    /**
+      * Decide on a frame.
+      *
+      * \param[in] frameTime time of the frame in the input.
+      * \param[in] now the current time.
+      * \return true if the frame should be processed.
+      */
+    bool shouldProcess(double frameTime, double now);
+
+    /// report the cost of a processed frame.
+    void processed(double cost);
+
+    inline uint64_t getNbFrames() const {return mFrames;}
+    inline uint64_t getNbSkipped() const {return mSkipped;}
+    inline unsigned getLongestSkipRun() const {return mLongestSkipRun;}
+    inline double getMeanCost() const {return mMeanCost;}
+    inline double getLag() const {return mLag;}
+
+    /// write the counters as one line of text.
+    void dumpText(std::ostream &out) const;
+
+  private:
+    double mBudget;
+    unsigned mMaxSkips;
+
+    double mStart;       ///< time at which the input time 0 is due.
+    double mMeanCost;    ///< moving average of the cost of a processed frame.
+    double mLag;         ///< lag of the last frame.
+    unsigned mSkipRun;   ///< frames skipped in a row so far.
+
+    uint64_t mFrames;
+    uint64_t mSkipped;
+    unsigned mLongestSkipRun;
+  };
+}
+
+#endif // LOADSHEDDER_HPP
@@ -0,0 +1,105 @@
+#include "MotionGate.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace Rbe;
+
+namespace
+{
+  /// sum of absolute differences of two rows, the row is copied to previous.
+  uint64_t sadRow(const uint8_t *row, uint8_t *previous, unsigned width)
+  {
+    uint64_t sad = 0;
+    unsigned x = 0;
+#ifdef __SSE2__
+    __m128i acc = _mm_setzero_si128();
+    for(; x + 16 <= width; x += 16)
+    {
+      __m128i a = _mm_loadu_si128((const __m128i *)(row + x));
+      __m128i b = _mm_loadu_si128((const __m128i *)(previous + x));
+      acc = _mm_add_epi64(acc, _mm_sad_epu8(a, b));
+      _mm_storeu_si128((__m128i *)(previous + x), a);
+    }
+    sad = (uint64_t)_mm_cvtsi128_si32(acc) + (uint64_t)_mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+#endif
+    for(; x < width; x++)
+    {
+      sad += abs((int)row[x] - (int)previous[x]);
+      previous[x] = row[x];
+    }
+    return sad;
+  }
+}
+
+MotionGate::MotionGate()
+{
+  configure(4, 2.0, 50, 25);
+}
+
+void MotionGate::configure(unsigned rowStep, double threshold, unsigned idleFrames, unsigned idleInterval)
+{
+  mRowStep = rowStep > 0 ? rowStep : 1;
+  mThreshold = threshold;
+  mIdleFrames = idleFrames;
+  mIdleInterval = idleInterval > 0 ? idleInterval : 1;
+
+  mPrevious.clear();
+  mWidth = 0;
+  mHeight = 0;
+  mStillFrames = 0;
+  mIdleCount = 0;
+  mIdle = false;
+  mEnergy = 0;
+}
+
+bool MotionGate::update(const Vi::Image<> &frame)
+{
+  unsigned width = frame.w();
+  unsigned rows = (frame.h() + mRowStep - 1) / mRowStep;
+
+  // the first frame (or a new size) is only a reference, it counts as motion
+  if(width != mWidth || frame.h() != mHeight || mPrevious.empty())
+  {
+    mWidth = width;
+    mHeight = frame.h();
+    mPrevious.resize(width * rows);
+    for(unsigned i = 0; i < rows; i++)
+      memcpy(&mPrevious[i * width], frame.Y(i * mRowStep), width);
+    mStillFrames = 0;
+    mIdle = false;
+    mEnergy = 0;
+    return true;
+  }
+
+  uint64_t sad = 0;
+  for(unsigned i = 0; i < rows; i++)
+    sad += sadRow(frame.Y(i * mRowStep), &mPrevious[i * width], width);
+  mEnergy = rows * width > 0 ? (double)sad / (rows * width) : 0;
+
+  if(mEnergy > mThreshold)
+  {
+    mStillFrames = 0;
+    mIdle = false;
+    return true;
+  }
+
+  if(!mIdle && ++mStillFrames >= mIdleFrames)
+  {
+    mIdle = true;
+    mIdleCount = 0;
+  }
+  if(!mIdle)
+    return true;
+
+  if(++mIdleCount >= mIdleInterval)
+  {
+    mIdleCount = 0;
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,71 @@
+/** \file
+  * The MotionGate class file. A cheap per-frame motion test that lets the
+  * video pipeline idle on static scenes.
+  *
+  * $Id$
+  */
+
+#ifndef MOTIONGATE_HPP
+#define MOTIONGATE_HPP
+
+#include <vector>
+#include <stdint.h>
+
+#include <ViNotion/Image.hpp>
+
+namespace Rbe
+{
+  /**
+    * Every rowStep-th luma row of a frame is compared with the same row of
+    * the previous frame (sum of absolute differences, SSE2 when available).
+    * The motion energy is the mean absolute difference per compared pixel.
+    *
+    * After idleFrames frames with an energy below the threshold the gate
+    * goes idle: update() then only asks for one frame in idleInterval to be
+    * processed, which keeps the background model current. The first frame
+    * above the threshold wakes the gate up again.
+    */
+  class MotionGate
+  {
+  public:
+    MotionGate();
+
+    /**
+      * Set the parameters, the gate starts awake.
+      *
+      * \param[in] rowStep compare one luma row in rowStep.
+      * \param[in] threshold motion energy (mean absolute difference) that counts as motion.
+      * \param[in] idleFrames number of still frames before the gate goes idle.
+      * \param[in] idleInterval while idle, process one frame in idleInterval.
+      */
+    void configure(unsigned rowStep, double threshold, unsigned idleFrames, unsigned idleInterval);
+
+    /**
+      * Test a frame, only its current subimage is read.
+      *
+      * \return true if the frame should go through the pipeline.
+      */
+    bool update(const Vi::Image<> &frame);
+
+    inline bool isIdle() const {return mIdle;}
+
+    /// motion energy of the last frame.
+    inline double getEnergy() const {return mEnergy;}
+
+  private:
+    unsigned mRowStep;
+    double mThreshold;
+    unsigned mIdleFrames;
+    unsigned mIdleInterval;
+
+    std::vector<uint8_t> mPrevious;  ///< the compared rows of the previous frame.
+    unsigned mWidth;
+    unsigned mHeight;
+    unsigned mStillFrames;           ///< frames since the last motion.
+    unsigned mIdleCount;             ///< frames since the last processed idle frame.
+    bool mIdle;
+    double mEnergy;
+  };
+}
+
+#endif // MOTIONGATE_HPP
@@ -0,0 +1,74 @@
+#include "ProcessingRoi.hpp"
+
+#include <algorithm>
+
+#include "src/core/Context.hpp"
+
+using namespace Rbe;
+
+ProcessingRoi::ProcessingRoi()
+{
+  setFullFrame(0, 0);
+}
+
+void ProcessingRoi::setFullFrame(unsigned width, unsigned height)
+{
+  mRect.x = 0;
+  mRect.y = 0;
+  mRect.width = width;
+  mRect.height = height;
+  mFullFrame = true;
+}
+
+void ProcessingRoi::compute(const std::vector<Context *> &contexts, unsigned margin, unsigned width, unsigned height)
+{
+  int x0 = width, y0 = height, x1 = 0, y1 = 0;
+  for(unsigned i = 0; i < contexts.size(); i++)
+  {
+    Rect bounds = contexts[i]->getBounds();
+    if(bounds.width <= 0 || bounds.height <= 0)
+      continue;
+    x0 = std::min(x0, bounds.x);
+    y0 = std::min(y0, bounds.y);
+    x1 = std::max(x1, bounds.x + bounds.width);
+    y1 = std::max(y1, bounds.y + bounds.height);
+  }
+
+  if(x1 <= x0 || y1 <= y0)
+  {
+    setFullFrame(width, height);
+    return;
+  }
+
+  // grow by the margin, clamp to the frame, then align outwards to even pixels
+  x0 = std::max(0, x0 - (int)margin) & ~1;
+  y0 = std::max(0, y0 - (int)margin) & ~1;
+  x1 = std::min((int)width, x1 + (int)margin);
+  y1 = std::min((int)height, y1 + (int)margin);
+  x1 = std::min((int)width & ~1, (x1 + 1) & ~1);
+  y1 = std::min((int)height & ~1, (y1 + 1) & ~1);
+
+  if(x0 == 0 && y0 == 0 && x1 >= ((int)width & ~1) && y1 >= ((int)height & ~1))
+  {
+    setFullFrame(width, height);
+    return;
+  }
+
+  mRect.x = x0;
+  mRect.y = y0;
+  mRect.width = x1 - x0;
+  mRect.height = y1 - y0;
+  mFullFrame = false;
+}
+
+void ProcessingRoi::pushSubimage(const Vi::Image<> &frame) const
+{
+  if(!mFullFrame)
+    frame.pushSubimage(mRect.x, mRect.y, mRect.width, mRect.height);
+}
+
+void ProcessingRoi::popSubimage(const Vi::Image<> &frame) const
+{
+  if(!mFullFrame)
+    frame.popSubimage();
+}
@@ -0,0 +1,64 @@
+/** \file
+  * The ProcessingRoi class file. The part of the frame the tracker runs on,
+  * derived from the contexts of the engine.
+  *
+  * $Id$
+  */
+
+#ifndef PROCESSINGROI_HPP
+#define PROCESSINGROI_HPP
+
+#include <vector>
+
+#include <ViNotion/Image.hpp>
+
+#include "src/core/Misc.hpp"
+
+namespace Rbe
+{
+  class Context;
+
+  /**
+    * Bounding rectangle of all contexts, grown by a margin so objects are
+    * tracked for a while before they reach a context. Only this part of the
+    * frame is tracked; object positions are then relative to getRect().x/y.
+    *
+    * The rectangle is aligned to even pixels so chroma subsampled formats
+    * crop cleanly. Without contexts the whole frame is used.
+    */
+  class ProcessingRoi
+  {
+  public:
+    ProcessingRoi();
+
+    /**
+      * Compute the rectangle.
+      *
+      * \param[in] contexts the contexts, in frame coordinates.
+      * \param[in] margin pixels added around the contexts.
+      * \param[in] width width of the frames.
+      * \param[in] height height of the frames.
+      */
+    void compute(const std::vector<Context *> &contexts, unsigned margin, unsigned width, unsigned height);
+
+    /// use the whole frame.
+    void setFullFrame(unsigned width, unsigned height);
+
+    inline const Rect &getRect() const {return mRect;}
+    inline bool isFullFrame() const {return mFullFrame;}
+
+    /**
+      * Make the rectangle the current subimage of frame (to read it or to
+      * draw in tracker coordinates), popSubimage() restores it. Both do
+      * nothing for the whole frame.
+      */
+    void pushSubimage(const Vi::Image<> &frame) const;
+    void popSubimage(const Vi::Image<> &frame) const;
+
+  private:
+    Rect mRect;
+    bool mFullFrame;
+  };
+}
+
+#endif // PROCESSINGROI_HPP
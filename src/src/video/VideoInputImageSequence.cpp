@@ -0,0 +1,266 @@
+#include "VideoInputImageSequence.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+
+#include <ViNotion/ImageFile.hpp>
+#include <ViNotion/ConvertIm.hpp>
+
+using namespace Rbe;
+
+namespace
+{
+  bool isImageFile(const std::string &fileName)
+  {
+    size_t dot = fileName.rfind('.');
+    if(dot == std::string::npos)
+      return false;
+
+    std::string extension = fileName.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == "png" || extension == "jpg" || extension == "jpeg" ||
+           extension == "pgm" || extension == "ppm";
+  }
+}
+
+VideoInputImageSequence::VideoInputImageSequence() :
+  mFrameRate(25)
+{
+  mWidth = 0;
+  mHeight = 0;
+  mLoop = false;
+  mNext = 0;
+  mDispatch = 0;
+  mGeneration = 0;
+  mStop = false;
+}
+
+VideoInputImageSequence::~VideoInputImageSequence()
+{
+  close();
+}
+
+bool VideoInputImageSequence::open(const std::string &directory, unsigned threads, unsigned depth)
+{
+  close();
+
+  namespace fs = boost::filesystem;
+  if(!fs::is_directory(directory))
+    return false;
+
+  for(fs::directory_iterator it(directory); it != fs::directory_iterator(); ++it)
+  {
+    std::string fileName = it->path().string();
+    if(!fs::is_directory(it->path()) && isImageFile(fileName))
+      mFiles.push_back(fileName);
+  }
+  std::sort(mFiles.begin(), mFiles.end());
+  if(mFiles.empty())
+    return false;
+
+  // the frame size of a sequence is that of its first image
+  Vi::Image<> *first = new Vi::Image<>();
+  Vi::Image<> *scratch = new Vi::Image<>();
+  try
+  {
+    decode(mFiles[0], first, scratch);
+  }
+  catch (const std::exception &)
+  {
+    delete first;
+    delete scratch;
+    mFiles.clear();
+    return false;
+  }
+  mWidth = first->w();
+  mHeight = first->h();
+  delete scratch;
+
+  // leave a core to the analysis
+  if(threads == 0)
+  {
+    // hardware_concurrency() is 0 when the number of cores is unknown
+    unsigned cores = boost::thread::hardware_concurrency();
+    threads = cores > 1 ? cores - 1 : 1;
+  }
+  if(depth == 0)
+    depth = 2 * threads;
+
+  mSlots.resize(std::max(1u, depth));
+  for(unsigned i = 0; i < mSlots.size(); i++)
+  {
+    mSlots[i].frame = 0;
+    mSlots[i].ready = false;
+    mSlots[i].image = i == 0 ? first : new Vi::Image<>();
+  }
+  mSlots[0].ready = true;
+
+  mNext = 0;
+  mDispatch = 1;
+  mGeneration = 0;
+  mStop = false;
+  for(unsigned i = 0; i < threads; i++)
+    mThreads.push_back(mWorkers.create_thread(boost::bind(&VideoInputImageSequence::run, this)));
+  return true;
+}
+
+void VideoInputImageSequence::close()
+{
+  {
+    boost::mutex::scoped_lock lock(mMutex);
+    mStop = true;
+    mWork.notify_all();
+  }
+  mWorkers.join_all();
+
+  // the joined threads are dropped, so the group can be filled again
+  for(unsigned i = 0; i < mThreads.size(); i++)
+  {
+    mWorkers.remove_thread(mThreads[i]);
+    delete mThreads[i];
+  }
+  mThreads.clear();
+
+  for(unsigned i = 0; i < mSlots.size(); i++)
+    delete mSlots[i].image;
+  mSlots.clear();
+  mFiles.clear();
+  mWidth = 0;
+  mHeight = 0;
+  mNext = 0;
+  mDispatch = 0;
+}
+
+bool VideoInputImageSequence::read(Vi::Image<> &image)
+{
+  if(mSlots.empty())
+    return false;
+
+  if(eof())
+  {
+    if(!mLoop)
+      return false;
+    seek(0, Vi::VPI_SEEK_SET);
+  }
+
+  boost::mutex::scoped_lock lock(mMutex);
+  Slot &slot = mSlots[mNext % mSlots.size()];
+  while(!slot.ready || slot.frame != mNext)
+    mDecoded.wait(lock);
+  lock.unlock();
+
+  // the slot is only reused for a frame that is dispatched after mNext moved on
+  std::string error = slot.error;
+  if(error.empty())
+    image = *slot.image;
+
+  lock.lock();
+  slot.ready = false;
+  mNext++;
+  mWork.notify_all();
+  lock.unlock();
+
+  if(!error.empty())
+    throw std::runtime_error("[VideoInputImageSequence::read]: " + error);
+  return true;
+}
+
+uint64_t VideoInputImageSequence::seek(int64_t offset, Vi::VideoPosId whence)
+{
+  boost::mutex::scoped_lock lock(mMutex);
+
+  int64_t base = 0;
+  if(whence == Vi::VPI_SEEK_CUR)
+    base = mNext;
+  else if(whence == Vi::VPI_SEEK_END)
+  {
+    // the offset from the end is a backwards offset
+    base = mFiles.size();
+    offset = -offset;
+  }
+
+  int64_t frame = std::max((int64_t)0, std::min(base + offset, (int64_t)mFiles.size()));
+  if((uint64_t)frame == mNext)
+    return mNext;
+
+  // the frames decoded ahead are dropped, those in the workers are dropped when done
+  mGeneration++;
+  for(unsigned i = 0; i < mSlots.size(); i++)
+    mSlots[i].ready = false;
+  mNext = frame;
+  mDispatch = frame;
+  mWork.notify_all();
+  return mNext;
+}
+
+VideoInputImageSequence &VideoInputImageSequence::setLoop(bool state)
+{
+  mLoop = state;
+  return *this;
+}
+
+void VideoInputImageSequence::run()
+{
+  Vi::Image<> *image = new Vi::Image<>();
+  Vi::Image<> *scratch = new Vi::Image<>();
+
+  boost::mutex::scoped_lock lock(mMutex);
+  while(!mStop)
+  {
+    // at most one frame per slot is ahead of the reader
+    if(mDispatch >= mFiles.size() || mDispatch >= mNext + mSlots.size())
+    {
+      mWork.wait(lock);
+      continue;
+    }
+
+    uint64_t frame = mDispatch++;
+    unsigned generation = mGeneration;
+    const std::string &fileName = mFiles[frame];
+    lock.unlock();
+
+    std::string error;
+    try
+    {
+      decode(fileName, image, scratch);
+    }
+    catch (const std::exception &e)
+    {
+      error = fileName + ": " + e.what();
+    }
+
+    lock.lock();
+    if(generation == mGeneration)
+    {
+      Slot &slot = mSlots[frame % mSlots.size()];
+      std::swap(slot.image, image);
+      slot.frame = frame;
+      slot.error = error;
+      slot.ready = true;
+      mDecoded.notify_all();
+    }
+  }
+  lock.unlock();
+
+  delete image;
+  delete scratch;
+}
+
+void VideoInputImageSequence::decode(const std::string &fileName, Vi::Image<> *&image, Vi::Image<> *&scratch)
+{
+  Vi::readImage(*scratch, fileName);
+  if(scratch->fmt() == Vi::PF_YCC444P)
+  {
+    std::swap(image, scratch);
+    return;
+  }
+
+  if(image->fmt() != Vi::PF_YCC444P)
+    image->fmt(Vi::PF_YCC444P);
+  if(image->w() != scratch->w() || image->h() != scratch->h())
+    image->resize(scratch->w(), scratch->h());
+  Vi::convertIm(*image, *scratch);
+}
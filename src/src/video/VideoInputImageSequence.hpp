@@ -0,0 +1,103 @@
+/** \file
+  * The VideoInputImageSequence class file. A video input on a directory of
+  * images, decoded ahead on a pool of threads.
+  *
+  * $Id$
+  */
+
+#ifndef VIDEOINPUTIMAGESEQUENCE_HPP
+#define VIDEOINPUTIMAGESEQUENCE_HPP
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <ViNotion/Image.hpp>
+#include <ViNotion/Misc.hpp>
+#include <ViNotion/VideoInput.hpp>
+
+namespace Rbe
+{
+  /**
+    * The frames are the PNG, JPEG, PGM and PPM files of a directory, in the
+    * order of their names. The worker threads decode the files after the
+    * one that is read next, up to depth files ahead, into a reorder buffer;
+    * read() takes the frames from it strictly in order, so the decoding of
+    * a sequence scales with the threads until the analysis is the slowest.
+    *
+    * Frames are delivered as PF_YCC444P, like those of the video file
+    * input. A file that cannot be decoded makes read() throw, like
+    * Vi::VideoInputImageFile does.
+    */
+  class VideoInputImageSequence : public Vi::VideoInput
+  {
+  public:
+    VideoInputImageSequence();
+    ~VideoInputImageSequence();
+
+    /**
+      * List the images of the directory, decode the first one for the frame
+      * size and start the workers.
+      *
+      * \param[in] directory the directory of the images.
+      * \param[in] threads decoding threads, 0 for one less than the cores.
+      * \param[in] depth frames decoded ahead, 0 for twice the threads.
+      * \return false if there are no images or the first one cannot be read.
+      */
+    bool open(const std::string &directory, unsigned threads = 0, unsigned depth = 0);
+
+    /// Stop the workers and drop the decoded frames.
+    void close();
+
+    inline bool isOpen() const {return !mSlots.empty();}
+
+    bool read(Vi::Image<> &image);
+    uint64_t seek(int64_t offset, Vi::VideoPosId whence = Vi::VPI_SEEK_CUR);
+    uint64_t tell() const {return mNext;}
+    bool eof() const {return mNext >= mFiles.size();}
+    unsigned int getWidth() const {return mWidth;}
+    unsigned int getHeight() const {return mHeight;}
+    uint64_t getLength() const {return mFiles.size();}
+    VideoInputImageSequence &setLoop(bool state = true);
+
+    /// An image sequence has no frame rate of its own, 25 by default.
+    inline Vi::Frac<int> getFrameRate() const {return mFrameRate;}
+    inline void setFrameRate(const Vi::Frac<int> &frameRate) {mFrameRate = frameRate;}
+
+  private:
+    /// One place of the reorder buffer, frame i goes to slot i % depth.
+    struct Slot
+    {
+      uint64_t frame;       ///< the frame in image, when ready.
+      bool ready;
+      Vi::Image<> *image;   ///< swapped with the image of the worker.
+      std::string error;    ///< why the frame could not be decoded.
+    };
+
+    void run();
+    static void decode(const std::string &fileName, Vi::Image<> *&image, Vi::Image<> *&scratch);
+
+    std::vector<std::string> mFiles;
+    unsigned mWidth;
+    unsigned mHeight;
+    Vi::Frac<int> mFrameRate;
+    bool mLoop;
+
+    boost::thread_group mWorkers;
+    std::vector<boost::thread *> mThreads; ///< the threads of mWorkers.
+    boost::mutex mMutex;                ///< guards the members below.
+    boost::condition_variable mWork;    ///< a frame can be dispatched.
+    boost::condition_variable mDecoded; ///< a slot became ready.
+    std::vector<Slot> mSlots;
+    uint64_t mNext;                     ///< the frame read() returns next.
+    uint64_t mDispatch;                 ///< the next frame for a worker.
+    unsigned mGeneration;               ///< counts seeks, older decodes are dropped.
+    bool mStop;
+  };
+}
+
+#endif // VIDEOINPUTIMAGESEQUENCE_HPP
@@ -0,0 +1,331 @@
+#include "VideoInputY4M.hpp"
+
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace Rbe;
+
+namespace
+{
+  const char STREAM_MAGIC[] = "YUV4MPEG2";
+  const char FRAME_MAGIC[] = "FRAME";
+
+  /// the y4m colour space tag of a format, NULL if it has none.
+  const char *colourSpaceTag(Vi::PIXEL_FORMAT format)
+  {
+    if(format == Vi::PF_YCC444P) return "444";
+    if(format == Vi::PF_YCC420P) return "420jpeg";
+    if(format == Vi::PF_Y) return "mono";
+    return NULL;
+  }
+}
+
+VideoInputY4M::VideoInputY4M() :
+  mFrameRate(25)
+{
+  mData = NULL;
+  mSize = 0;
+  mWidth = 0;
+  mHeight = 0;
+  mFormat = Vi::PF_YCC420P;
+  mChromaWidth = 0;
+  mChromaHeight = 0;
+  mFrameSize = 0;
+  mNext = 0;
+  mLoop = false;
+}
+
+VideoInputY4M::~VideoInputY4M()
+{
+  close();
+}
+
+bool VideoInputY4M::open(const std::string &fileName)
+{
+  if(!map(fileName))
+    return false;
+
+  uint64_t offset = 0;
+  if(!parseHeader(offset))
+  {
+    close();
+    return false;
+  }
+
+  // every frame has its own header, which may carry parameters
+  const unsigned frameMagicSize = sizeof(FRAME_MAGIC) - 1;
+  while(offset + frameMagicSize < mSize && memcmp(mData + offset, FRAME_MAGIC, frameMagicSize) == 0)
+  {
+    const unsigned char *end = (const unsigned char *)memchr(mData + offset, '\n', mSize - offset);
+    if(end == NULL)
+      break;
+
+    uint64_t planes = end + 1 - mData;
+    if(planes + mFrameSize > mSize)
+      break;  // truncated last frame
+    mFrames.push_back(planes);
+    offset = planes + mFrameSize;
+  }
+  return true;
+}
+
+bool VideoInputY4M::openRaw(const std::string &fileName, unsigned width, unsigned height,
+                            Vi::PIXEL_FORMAT format, const Vi::Frac<int> &frameRate)
+{
+  if(!map(fileName) || !setFormat(width, height, format))
+  {
+    close();
+    return false;
+  }
+  mFrameRate = frameRate;
+
+  for(uint64_t offset = 0; offset + mFrameSize <= mSize; offset += mFrameSize)
+    mFrames.push_back(offset);
+  return true;
+}
+
+void VideoInputY4M::close()
+{
+  if(mData != NULL)
+    munmap(mData, mSize);
+  mData = NULL;
+  mSize = 0;
+  mWidth = 0;
+  mHeight = 0;
+  mFrames.clear();
+  mNext = 0;
+}
+
+bool VideoInputY4M::map(const std::string &fileName)
+{
+  close();
+
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  if(fd < 0)
+    return false;
+
+  struct stat status;
+  if(fstat(fd, &status) != 0 || status.st_size == 0)
+  {
+    ::close(fd);
+    return false;
+  }
+
+  // private and writable: the frames can be drawn on without changing the file
+  void *data = mmap(NULL, status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if(data == MAP_FAILED)
+    return false;
+
+  madvise(data, status.st_size, MADV_SEQUENTIAL);
+  mData = (unsigned char *)data;
+  mSize = status.st_size;
+  return true;
+}
+
+bool VideoInputY4M::setFormat(unsigned width, unsigned height, Vi::PIXEL_FORMAT format)
+{
+  if(width == 0 || height == 0)
+    return false;
+
+  if(format == Vi::PF_YCC444P)
+  {
+    mChromaWidth = width;
+    mChromaHeight = height;
+  }
+  else if(format == Vi::PF_YCC420P)
+  {
+    mChromaWidth = (width + 1) / 2;
+    mChromaHeight = (height + 1) / 2;
+  }
+  else if(format == Vi::PF_Y)
+  {
+    mChromaWidth = 0;
+    mChromaHeight = 0;
+  }
+  else
+    return false;
+
+  mWidth = width;
+  mHeight = height;
+  mFormat = format;
+  mFrameSize = (uint64_t)width * height + 2 * (uint64_t)mChromaWidth * mChromaHeight;
+  return true;
+}
+
+bool VideoInputY4M::parseHeader(uint64_t &offset)
+{
+  const unsigned magicSize = sizeof(STREAM_MAGIC) - 1;
+  if(mSize < magicSize || memcmp(mData, STREAM_MAGIC, magicSize) != 0)
+    return false;
+
+  const unsigned char *end = (const unsigned char *)memchr(mData, '\n', mSize);
+  if(end == NULL)
+    return false;
+
+  std::string header((const char *)mData + magicSize, (const char *)end);
+  offset = end + 1 - mData;
+
+  unsigned width = 0;
+  unsigned height = 0;
+  std::string colourSpace = "420";
+  mFrameRate = Vi::Frac<int>(25);
+
+  // the parameters are a tag character and a value, separated by spaces
+  size_t start = 0;
+  while(start < header.size())
+  {
+    size_t stop = header.find(' ', start);
+    if(stop == std::string::npos)
+      stop = header.size();
+    if(stop > start)
+    {
+      char tag = header[start];
+      std::string value = header.substr(start + 1, stop - start - 1);
+      if(tag == 'W')
+        width = atoi(value.c_str());
+      else if(tag == 'H')
+        height = atoi(value.c_str());
+      else if(tag == 'C')
+        colourSpace = value;
+      else if(tag == 'F')
+      {
+        int num = 0;
+        int den = 0;
+        size_t colon = value.find(':');
+        if(colon != std::string::npos)
+        {
+          num = atoi(value.substr(0, colon).c_str());
+          den = atoi(value.substr(colon + 1).c_str());
+        }
+        if(num > 0 && den > 0)
+          mFrameRate = Vi::Frac<int>(num, den);
+      }
+    }
+    start = stop + 1;
+  }
+
+  // all 4:2:0 chroma sitings share the plane layout
+  Vi::PIXEL_FORMAT format;
+  if(colourSpace == "444")
+    format = Vi::PF_YCC444P;
+  else if(colourSpace.compare(0, 3, "420") == 0)
+    format = Vi::PF_YCC420P;
+  else if(colourSpace == "mono")
+    format = Vi::PF_Y;
+  else
+    return false;
+
+  return setFormat(width, height, format);
+}
+
+bool VideoInputY4M::read(Vi::Image<> &image)
+{
+  if(eof())
+  {
+    if(!mLoop || mFrames.empty())
+      return false;
+    mNext = 0;
+  }
+
+  unsigned char *planes = mData + mFrames[mNext++];
+
+  if(image.fmt() != mFormat)
+    image.fmt(mFormat);
+  image.size(mWidth, mHeight, false);
+
+  for(unsigned y = 0; y < mHeight; y++)
+    image.Y(y) = planes + (uint64_t)y * mWidth;
+
+  if(mChromaWidth > 0)
+  {
+    unsigned char *cb = planes + (uint64_t)mWidth * mHeight;
+    unsigned char *cr = cb + (uint64_t)mChromaWidth * mChromaHeight;
+    unsigned rows = mFormat == Vi::PF_YCC420P ? mHeight / 2 : mHeight;
+    for(unsigned y = 0; y < rows; y++)
+    {
+      image.Cb(y) = cb + (uint64_t)y * mChromaWidth;
+      image.Cr(y) = cr + (uint64_t)y * mChromaWidth;
+    }
+  }
+  return true;
+}
+
+uint64_t VideoInputY4M::seek(int64_t offset, Vi::VideoPosId whence)
+{
+  int64_t base = 0;
+  if(whence == Vi::VPI_SEEK_CUR)
+    base = mNext;
+  else if(whence == Vi::VPI_SEEK_END)
+  {
+    // the offset from the end is a backwards offset
+    base = mFrames.size();
+    offset = -offset;
+  }
+
+  int64_t frame = base + offset;
+  if(frame < 0)
+    frame = 0;
+  if(frame > (int64_t)mFrames.size())
+    frame = mFrames.size();
+  mNext = frame;
+  return mNext;
+}
+
+VideoInputY4M &VideoInputY4M::setLoop(bool state)
+{
+  mLoop = state;
+  return *this;
+}
+
+bool Rbe::writeY4MHeader(std::ostream &out, unsigned width, unsigned height,
+                         Vi::PIXEL_FORMAT format, const Vi::Frac<int> &frameRate)
+{
+  const char *tag = colourSpaceTag(format);
+  if(tag == NULL)
+    return false;
+
+  out << STREAM_MAGIC << " W" << width << " H" << height
+      << " F" << frameRate.mNum << ":" << frameRate.mDen
+      << " Ip A1:1 C" << tag << "\n";
+  return out.good();
+}
+
+void Rbe::writeY4MFrame(std::ostream &out, const Vi::Image<> &frame)
+{
+  out << FRAME_MAGIC << "\n";
+
+  unsigned width = frame.w();
+  unsigned height = frame.h();
+  for(unsigned y = 0; y < height; y++)
+    out.write((const char *)frame.Y(y), width);
+
+  if(frame.fmt() == Vi::PF_Y)
+    return;
+
+  // the rows of an odd sized 4:2:0 frame are repeated to the y4m plane size
+  bool subsampled = frame.fmt() == Vi::PF_YCC420P;
+  unsigned chromaWidth = subsampled ? (width + 1) / 2 : width;
+  unsigned chromaHeight = subsampled ? (height + 1) / 2 : height;
+  unsigned rows = subsampled ? height / 2 : height;
+  unsigned columns = subsampled ? width / 2 : width;
+
+  std::vector<char> row(chromaWidth);
+  for(unsigned plane = 1; plane <= 2; plane++)
+  {
+    for(unsigned y = 0; y < chromaHeight; y++)
+    {
+      const uint8_t *source = plane == 1 ? frame.Cb(std::min(y, rows - 1)) : frame.Cr(std::min(y, rows - 1));
+      memcpy(&row[0], source, columns);
+      if(chromaWidth > columns)
+        row[chromaWidth - 1] = row[columns - 1];
+      out.write(&row[0], chromaWidth);
+    }
+  }
+}
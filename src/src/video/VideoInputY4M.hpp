@@ -0,0 +1,116 @@
+/** \file
+  * A video input on a memory mapped YUV4MPEG2 (.y4m) or raw planar YUV file.
+  *
+  * $Id$
+  */
+
+#ifndef VIDEOINPUTY4M_HPP
+#define VIDEOINPUTY4M_HPP
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <stdint.h>
+
+#include <ViNotion/Image.hpp>
+#include <ViNotion/Misc.hpp>
+#include <ViNotion/VideoInput.hpp>
+
+namespace Rbe
+{
+  /**
+    * Reads uncompressed video without decoding it: the file is mapped and
+    * read() points the rows of the image at the frame in the mapping, so a
+    * frame costs no copy and, once the file is in the page cache, no I/O.
+    * Benchmarks on such a file measure the analysis alone.
+    *
+    * The mapping is private: drawing on a frame copies the touched pages
+    * and never changes the file. The rows stay valid until close().
+    *
+    * Supported are 4:4:4 (PF_YCC444P), 4:2:0 (PF_YCC420P) and luma only
+    * (PF_Y) planar frames of 8 bits. rbe-y4m converts a clip to a .y4m.
+    */
+  class VideoInputY4M : public Vi::VideoInput
+  {
+  public:
+    VideoInputY4M();
+    ~VideoInputY4M();
+
+    /**
+      * Map a .y4m file and index its frames.
+      *
+      * \param[in] fileName path of the file.
+      * \return false if the file cannot be mapped or is no supported y4m.
+      */
+    bool open(const std::string &fileName);
+
+    /**
+      * Map a raw file of planar frames without headers.
+      *
+      * \param[in] fileName path of the file.
+      * \param[in] width width of the frames.
+      * \param[in] height height of the frames.
+      * \param[in] format PF_YCC444P, PF_YCC420P or PF_Y.
+      * \param[in] frameRate frame rate reported by getFrameRate().
+      * \return false if the file cannot be mapped or the format is not supported.
+      */
+    bool openRaw(const std::string &fileName, unsigned width, unsigned height,
+                 Vi::PIXEL_FORMAT format = Vi::PF_YCC420P,
+                 const Vi::Frac<int> &frameRate = Vi::Frac<int>(25));
+
+    /// Unmap the file, images read from it must not be used anymore.
+    void close();
+
+    inline bool isOpen() const {return mData != NULL;}
+
+    /**
+      * Point image at the next frame, the image gets the format of the file
+      * and no memory of its own.
+      */
+    bool read(Vi::Image<> &image);
+    uint64_t seek(int64_t offset, Vi::VideoPosId whence = Vi::VPI_SEEK_CUR);
+    uint64_t tell() const {return mNext;}
+    bool eof() const {return mNext >= mFrames.size();}
+    unsigned int getWidth() const {return mWidth;}
+    unsigned int getHeight() const {return mHeight;}
+    uint64_t getLength() const {return mFrames.size();}
+    VideoInputY4M &setLoop(bool state = true);
+
+    inline Vi::PIXEL_FORMAT getFormat() const {return mFormat;}
+    inline Vi::Frac<int> getFrameRate() const {return mFrameRate;}
+
+  private:
+    bool map(const std::string &fileName);
+    bool setFormat(unsigned width, unsigned height, Vi::PIXEL_FORMAT format);
+    bool parseHeader(uint64_t &offset);
+
+    unsigned char *mData;         ///< the mapped file, NULL when closed.
+    uint64_t mSize;
+
+    unsigned mWidth;
+    unsigned mHeight;
+    Vi::PIXEL_FORMAT mFormat;
+    Vi::Frac<int> mFrameRate;
+    unsigned mChromaWidth;        ///< 0 for PF_Y.
+    unsigned mChromaHeight;
+    uint64_t mFrameSize;          ///< bytes of the planes of one frame.
+
+    std::vector<uint64_t> mFrames; ///< offset of the planes of each frame.
+    uint64_t mNext;
+    bool mLoop;
+  };
+
+  /**
+    * Write the stream header of a .y4m file.
+    *
+    * \param[in] format PF_YCC444P, PF_YCC420P or PF_Y.
+    * \return false if the format cannot be written.
+    */
+  bool writeY4MHeader(std::ostream &out, unsigned width, unsigned height,
+                      Vi::PIXEL_FORMAT format, const Vi::Frac<int> &frameRate);
+
+  /// Write one frame of a .y4m file, in the format of its header.
+  void writeY4MFrame(std::ostream &out, const Vi::Image<> &frame);
+}
+
+#endif // VIDEOINPUTY4M_HPP
@@ -0,0 +1,19 @@
+#include "YuvView.hpp"
+
+using namespace Rbe;
+
+void Rbe::wrapYcc420(Vi::Image<> &view, unsigned width, unsigned height,
+                     uint8_t *const planes[3], const int linesizes[3])
+{
+  if(view.fmt() != Vi::PF_YCC420P)
+    view.fmt(Vi::PF_YCC420P);
+  view.size(width, height, false);
+
+  for(unsigned y = 0; y < height; y++)
+    view.Y(y) = planes[0] + y * linesizes[0];
+  for(unsigned y = 0; y < height / 2; y++)
+  {
+    view.Cb(y) = planes[1] + y * linesizes[1];
+    view.Cr(y) = planes[2] + y * linesizes[2];
+  }
+}
@@ -0,0 +1,26 @@
+/** \file
+  * Wraps decoded YUV 4:2:0 planes in a Vi::Image without copying them.
+  *
+  * $Id$
+  */
+
+#ifndef YUVVIEW_HPP
+#define YUVVIEW_HPP
+
+#include <stdint.h>
+
+#include <ViNotion/Image.hpp>
+
+namespace Rbe
+{
+  /**
+    * Point the rows of view (format PF_YCC420P, no memory of its own) at the
+    * planes of a decoded frame, e.g. those of QVideoDecoder::getFrameYuv.
+    * Nothing is copied or converted: the view is only valid as long as the
+    * planes are, and writing to it writes to the decoder's frame.
+    */
+  void wrapYcc420(Vi::Image<> &view, unsigned width, unsigned height,
+                  uint8_t *const planes[3], const int linesizes[3]);
+}
+
+#endif // YUVVIEW_HPP